@@ -0,0 +1,83 @@
+/**
+ * arena.c
+ * Bump allocator implementation - see arena.h
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "arena.h"
+
+#define ALIGN_UP(n) (((n) + ARENA_ALIGN - 1) & ~((size_t)ARENA_ALIGN - 1))
+#define CHUNK_HEADER ALIGN_UP(sizeof(ArenaChunk))
+
+void arena_init(Arena *a) {
+    a->head = NULL;
+}
+
+// returns a pointer to "size" bytes of memory owned by the arena, exits if memory runs out
+void *arena_alloc(Arena *a, size_t size) {
+    size = ALIGN_UP(size);
+    if (a->head == NULL || a->head->used + size > a->head->size) { // need a new chunk
+        size_t chunk_size = size > ARENA_CHUNK_SIZE ? size : ARENA_CHUNK_SIZE;
+        ArenaChunk *chunk = malloc(CHUNK_HEADER + chunk_size);
+        if (chunk == NULL) {
+            fprintf(stderr, "malloc() failed for arena chunk.\n");
+            exit(-1);
+        }
+        chunk->size = chunk_size;
+        if (a->head != NULL && size > ARENA_CHUNK_SIZE / 4) {
+            // large allocation gets its own chunk, keeping the free space left in the head chunk
+            chunk->used = size;
+            chunk->next = a->head->next;
+            a->head->next = chunk;
+            return (char *)chunk + CHUNK_HEADER;
+        }
+        chunk->used = 0;
+        chunk->next = a->head;
+        a->head = chunk;
+    }
+    void *ptr = (char *)a->head + CHUNK_HEADER + a->head->used;
+    a->head->used += size;
+    return ptr;
+}
+
+void pool_init(Pool *p) {
+    int i;
+    for (i = 0; i < POOL_CLASSES; i++) p->free_lists[i] = NULL;
+}
+
+// size class of a block: the smallest c such that (1 << (c + POOL_MIN_SHIFT)) >= size
+static int pool_class(size_t size) {
+    int c = 0;
+    while (((size_t)1 << (c + POOL_MIN_SHIFT)) < size) c++;
+    return c;
+}
+
+// returns a block of at least "size" bytes, reusing a freed one of the same class when possible
+void *pool_alloc(Pool *p, Arena *a, size_t size) {
+    int c = pool_class(size);
+    void *block = p->free_lists[c];
+    if (block != NULL) {
+        p->free_lists[c] = *(void **)block;
+        return block;
+    }
+    return arena_alloc(a, (size_t)1 << (c + POOL_MIN_SHIFT));
+}
+
+// gives back a block from pool_alloc; size must be the size it was allocated with
+void pool_free(Pool *p, void *block, size_t size) {
+    int c = pool_class(size);
+    *(void **)block = p->free_lists[c];
+    p->free_lists[c] = block;
+}
+
+// releases every allocation made from the arena at once
+void arena_free(Arena *a) {
+    ArenaChunk *chunk = a->head;
+    while (chunk != NULL) {
+        ArenaChunk *next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+    a->head = NULL;
+}
@@ -0,0 +1,44 @@
+/**
+ * arena.h
+ * A simple bump ("arena") allocator used to hold every Thread record and burst array
+ * of a workload. Allocations are never freed individually; the whole arena is released
+ * in one step with arena_free() once the simulation is finished.
+ * A Pool can sit on top of an arena when blocks do need to be given back before the end
+ * (e.g. when streaming threads in and out): freed blocks are kept on free lists by power-of-two
+ * size class and handed out again, so memory stays proportional to the blocks in use at once.
+ */
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+#define ARENA_ALIGN 16
+#define ARENA_CHUNK_SIZE (1 << 20) // default size of a chunk in bytes (1 MiB)
+
+typedef struct arena_chunk {
+    struct arena_chunk *next;
+    size_t used;
+    size_t size;
+} ArenaChunk;
+
+typedef struct arena_struct {
+    ArenaChunk *head; // chunk currently being allocated from (most recent first)
+} Arena;
+
+#define POOL_MIN_SHIFT 4 // smallest pool block is 16 bytes
+#define POOL_CLASSES 40
+
+typedef struct pool_struct {
+    void *free_lists[POOL_CLASSES]; // freed blocks of each size class, linked through their first word
+} Pool;
+
+void arena_init(Arena *a);
+void *arena_alloc(Arena *a, size_t size);
+void arena_free(Arena *a);
+
+void pool_init(Pool *p);
+void *pool_alloc(Pool *p, Arena *a, size_t size);
+void pool_free(Pool *p, void *block, size_t size);
+
+#endif
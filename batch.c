@@ -0,0 +1,316 @@
+/**
+ * batch.c
+ * Lockstep batch simulation - see batch.h
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include "batch.h"
+#include "report.h"
+
+typedef int BatchVec __attribute__((vector_size(BATCH_LANES * sizeof(int))));
+
+// every lane set to value
+#define SPLAT(value) ((BatchVec){0} + (value))
+
+// a where mask is set (all ones), b elsewhere
+#define SELECT(mask, a, b) (((a) & (mask)) | ((b) & ~(mask)))
+
+#define NUM_SLOT_ARRAYS 8
+
+// The lanes and the workloads queued for them. Every per-thread array has one entry per slot and
+// lane, at slot * BATCH_LANES + lane, so the same slot of every lane is one vector. A lane whose
+// workload finishes takes the next one from the queue, so the lanes stay busy until it is empty.
+typedef struct batch_struct {
+    Workload *const *workloads;
+    BatchResult *results;
+    const int *queue; // indices of the workloads the kernel runs, in order
+    int queued;
+    int next;         // first one not yet given to a lane
+    int slots;        // most threads of any of them
+    int *key;         // time the thread is next ready, INT_MAX once it has finished (or for an empty slot)
+    int *process_num;
+    int *thread_num;
+    int *base;        // index of its first burst in its lane's cpu and io
+    int *burst;       // current burst
+    int *remaining;   // CPU time left in the current burst
+    int *arrival;     // original arrival time
+    int *finish;
+    int *slot_mem;
+    // bursts of the lane's threads, each thread's after a marker with a CPU time of -1 (which ends
+    // the thread before it) and an I/O time of 0 (the wait before its first burst), plus a last marker
+    int *cpu[BATCH_LANES];
+    int *io[BATCH_LANES];
+    long capacity[BATCH_LANES];
+    int workload[BATCH_LANES]; // index of the lane's workload, -1 once the queue is empty
+    int threads_left[BATCH_LANES];
+    long dispatches[BATCH_LANES];
+    // per lane, as the engine's own state
+    BatchVec time;
+    BatchVec cpu_time;
+    BatchVec last_process; // last thread on the CPU
+    BatchVec last_thread;
+    BatchVec last_burst;
+    BatchVec same_switch;
+    BatchVec diff_switch;
+} Batch;
+
+// true if the workload's threads can all be simulated by the lockstep kernel under cfg
+bool batch_supports(const SimConfig *cfg, const Workload *w) {
+    return (cfg->policy == POLICY_FCFS || cfg->policy == POLICY_RR) && cfg->cores <= 1 && cfg->verbose == false
+            && cfg->count == false && cfg->on_pause == NULL && cfg->resume == NULL && w->threads.count <= BATCH_MAX_THREADS;
+}
+
+// orders threads a and b as the heap breaks ties between them: process, thread, then table index
+static inline bool thread_before(const Thread *threads, int a, int b) {
+    if (threads[a].process_num != threads[b].process_num) return threads[a].process_num < threads[b].process_num;
+    if (threads[a].thread_num != threads[b].thread_num) return threads[a].thread_num < threads[b].thread_num;
+    return a < b;
+}
+
+// fills in the results of the lane's workload; its slots are sorted by process, so each process's
+// threads are next to each other
+static void finish_lane(Batch *b, int lane) {
+    BatchResult *res = &b->results[b->workload[lane]];
+    int n = b->workloads[b->workload[lane]]->threads.count;
+    int s;
+    res->time_total = b->time[lane];
+    res->cpu_time_total = b->cpu_time[lane];
+    res->dispatches = b->dispatches[lane];
+    res->threads = n;
+    res->turnaround_total = 0;
+    for (s = 0; s < n; s++) {
+        int i = s * BATCH_LANES + lane;
+        int first_arrival = b->arrival[i];
+        int last_finish = b->finish[i];
+        while (s + 1 < n && b->process_num[i + BATCH_LANES] == b->process_num[i]) {
+            s++;
+            i += BATCH_LANES;
+            if (b->arrival[i] < first_arrival) first_arrival = b->arrival[i];
+            if (b->finish[i] > last_finish) last_finish = b->finish[i];
+        }
+        res->turnaround_total += last_finish - first_arrival;
+    }
+}
+
+// gives the lane the next queued workload with any threads (finishing the empty ones on the way),
+// its threads sorted by (process, thread); leaves the lane empty once the queue is
+static void load_lane(Batch *b, int lane) {
+    int order[BATCH_MAX_THREADS];
+    int i, j;
+    b->time[lane] = 0;
+    b->cpu_time[lane] = 0;
+    b->last_process[lane] = 0; // as the engine starts
+    b->last_thread[lane] = 0;
+    b->last_burst[lane] = 0;
+    b->dispatches[lane] = 0;
+    b->workload[lane] = -1;
+    b->threads_left[lane] = 0;
+    for (i = 0; i < b->slots; i++) b->key[i * BATCH_LANES + lane] = INT_MAX;
+    while (b->next < b->queued && b->threads_left[lane] == 0) {
+        b->workload[lane] = b->queue[b->next++];
+        b->threads_left[lane] = b->workloads[b->workload[lane]]->threads.count;
+        if (b->threads_left[lane] == 0) finish_lane(b, lane);
+    }
+    if (b->threads_left[lane] == 0) { // slot 0 is still read, so it is pointed at the first marker
+        b->workload[lane] = -1;
+        b->base[lane] = 1;
+        b->burst[lane] = 0;
+        return;
+    }
+
+    const Workload *w = b->workloads[b->workload[lane]];
+    const Thread *threads = w->threads.arr;
+    int n = w->threads.count;
+    long bursts = n + 1;
+    for (i = 0; i < n; i++) bursts += threads[i].burst_num;
+    if (bursts > b->capacity[lane]) {
+        free(b->cpu[lane]);
+        b->cpu[lane] = malloc(2 * bursts * sizeof(int));
+        if (b->cpu[lane] == NULL) {
+            fprintf(stderr, "malloc() failed for the bursts of a batch lane.\n");
+            exit(-1);
+        }
+        b->io[lane] = b->cpu[lane] + bursts;
+        b->capacity[lane] = bursts;
+    }
+    int *cpu = b->cpu[lane];
+    int *io = b->io[lane];
+    for (i = 0; i < n; i++) { // insertion sort, the workloads are small
+        for (j = i; j > 0 && thread_before(threads, i, order[j - 1]); j--) order[j] = order[j - 1];
+        order[j] = i;
+    }
+    long next = 0;
+    for (i = 0; i < n; i++) {
+        const Thread *t = &threads[order[i]];
+        int s = i * BATCH_LANES + lane;
+        cpu[next] = -1;
+        io[next++] = 0;
+        b->key[s] = t->original_arrival_time;
+        b->process_num[s] = t->process_num;
+        b->thread_num[s] = t->thread_num;
+        b->base[s] = (int)next;
+        b->burst[s] = 0;
+        b->remaining[s] = t->cpu_burst_times[0];
+        b->arrival[s] = t->original_arrival_time;
+        memcpy(cpu + next, t->cpu_burst_times, t->burst_num * sizeof(int));
+        memcpy(io + next, t->io_burst_times, t->burst_num * sizeof(int));
+        next += t->burst_num;
+    }
+    cpu[next] = -1;
+    io[next] = 0;
+    b->same_switch[lane] = w->units_same_switch;
+    b->diff_switch[lane] = w->units_diff_switch;
+}
+
+// One step of every lane, as one pass of the engine's single queue loop: the first queued thread is
+// put on the CPU, paying for the switch, and runs for one slice (its whole burst if quantum is 0).
+// Returns false once every lane is empty.
+static bool step(Batch *b, int quantum) {
+    int s, lane;
+    BatchVec best = SPLAT(INT_MAX);
+    BatchVec at = SPLAT(0);
+    for (s = 0; s < b->slots; s++) {
+        BatchVec key;
+        memcpy(&key, &b->key[s * BATCH_LANES], sizeof(BatchVec));
+        BatchVec less = key < best;
+        best = SELECT(less, key, best);
+        at = SELECT(less, SPLAT(s), at);
+    }
+    BatchVec live = best != SPLAT(INT_MAX);
+    bool any = false;
+    for (lane = 0; lane < BATCH_LANES; lane++) any |= live[lane] != 0;
+    if (any == false) return false;
+
+    // the chosen thread of each lane (slot 0 of an empty one, which is left alone)
+    BatchVec process, thread, burst, remaining, io_before, io_after, next_cpu;
+    for (lane = 0; lane < BATCH_LANES; lane++) {
+        int i = at[lane] * BATCH_LANES + lane;
+        int pos = b->base[i] + b->burst[i];
+        process[lane] = b->process_num[i];
+        thread[lane] = b->thread_num[i];
+        burst[lane] = b->burst[i];
+        remaining[lane] = b->remaining[i];
+        io_before[lane] = b->io[lane][pos - 1]; // 0 before the first burst
+        io_after[lane] = b->io[lane][pos];
+        next_cpu[lane] = b->cpu[lane][pos + 1]; // -1 after the last burst
+    }
+
+    // start_thread: a switch to another process or thread, or a wait for the thread's own I/O; the
+    // thread enters the CPU after it (the engine leaves its entry time alone at time 0, when it is 0)
+    BatchVec started = b->time != SPLAT(0);
+    BatchVec same_process = b->last_process == process;
+    BatchVec same_thread = b->last_thread == thread;
+    BatchVec waits_io = same_process & same_thread & (b->last_burst != burst - 1);
+    BatchVec cost = (b->diff_switch & ~same_process) | (b->same_switch & same_process & ~same_thread) | (io_before & waits_io);
+    BatchVec enters = b->time + (cost & started & live);
+    b->last_burst = SELECT(started & live, burst - 1, b->last_burst);
+
+    // run_slice: back in the queue when preempted or blocked, done after the last burst
+    BatchVec run = remaining;
+    if (quantum > 0) run = SELECT(SPLAT(quantum) < remaining, SPLAT(quantum), remaining);
+    BatchVec preempted = run < remaining;
+    b->cpu_time += run & live;
+    b->time = enters + (run & live);
+    BatchVec key = SELECT(preempted, run + enters, run + io_after + enters);
+    remaining = SELECT(preempted, remaining - run, next_cpu);
+    burst -= ~preempted; // + 1 unless preempted
+    BatchVec finished = ~preempted & (next_cpu < SPLAT(0));
+    key = SELECT(finished, SPLAT(INT_MAX), key);
+    b->last_process = SELECT(live, process, b->last_process);
+    b->last_thread = SELECT(live, thread, b->last_thread);
+
+    for (lane = 0; lane < BATCH_LANES; lane++) {
+        if (live[lane] == 0) continue;
+        int i = at[lane] * BATCH_LANES + lane;
+        b->key[i] = key[lane];
+        b->burst[i] = burst[lane];
+        b->remaining[i] = remaining[lane];
+        b->dispatches[lane]++;
+        if (finished[lane]) {
+            b->finish[i] = b->time[lane];
+            if (--b->threads_left[lane] == 0) {
+                finish_lane(b, lane);
+                load_lane(b, lane);
+            }
+        }
+    }
+    return true;
+}
+
+// runs the queued workloads through the lanes to the end, filling in their results
+static void run_lanes(Workload *const *workloads, const int *queue, int queued, int quantum, BatchResult *results) {
+    Batch b;
+    int i, lane;
+    memset(&b, 0, sizeof(Batch));
+    b.workloads = workloads;
+    b.results = results;
+    b.queue = queue;
+    b.queued = queued;
+    b.slots = 1;
+    for (i = 0; i < queued; i++) {
+        if (workloads[queue[i]]->threads.count > b.slots) b.slots = workloads[queue[i]]->threads.count;
+    }
+    size_t slot_ints = (size_t)b.slots * BATCH_LANES;
+    b.slot_mem = malloc(NUM_SLOT_ARRAYS * slot_ints * sizeof(int));
+    if (b.slot_mem == NULL) {
+        fprintf(stderr, "malloc() failed for a batch of workloads.\n");
+        exit(-1);
+    }
+    int **arrays[NUM_SLOT_ARRAYS] = {&b.key, &b.process_num, &b.thread_num, &b.base, &b.burst, &b.remaining, &b.arrival, &b.finish};
+    for (i = 0; i < NUM_SLOT_ARRAYS; i++) *arrays[i] = b.slot_mem + i * slot_ints;
+    for (lane = 0; lane < BATCH_LANES; lane++) {
+        b.capacity[lane] = 2; // room for the markers an empty lane reads
+        b.cpu[lane] = calloc(2 * b.capacity[lane], sizeof(int));
+        if (b.cpu[lane] == NULL) {
+            fprintf(stderr, "malloc() failed for the bursts of a batch lane.\n");
+            exit(-1);
+        }
+        b.io[lane] = b.cpu[lane] + b.capacity[lane];
+        load_lane(&b, lane);
+    }
+
+    while (step(&b, quantum));
+
+    for (lane = 0; lane < BATCH_LANES; lane++) free(b.cpu[lane]);
+    free(b.slot_mem);
+}
+
+// simulates one workload with the engine, for those the kernel does not cover
+static void run_single(Workload *w, const SimConfig *cfg, BatchResult *res) {
+    Report report;
+    SimResult sim;
+    reset_workload(w);
+    report_init(&report, false);
+    if (run_simulation(w, NULL, cfg, &report, &sim) != 0) {
+        fprintf(stderr, "ERROR: %s\n", sim.error);
+        exit(-1);
+    }
+    res->time_total = sim.time_total;
+    res->cpu_time_total = sim.cpu_time_total;
+    res->turnaround_total = report_turnaround_total(&report);
+    res->dispatches = sim.dispatches;
+    res->threads = sim.threads_read;
+    report_free(&report);
+    free_sim_result(&sim);
+}
+
+// Simulates each of the n fully loaded workloads under cfg, filling in results[i] for workloads[i].
+// Workloads the lockstep kernel covers are only read; the others are reset and run by run_simulation.
+void run_batch(Workload *const *workloads, int n, const SimConfig *cfg, BatchResult *results) {
+    int *queue = malloc((n > 0 ? n : 1) * sizeof(int));
+    int queued = 0;
+    int i;
+    if (queue == NULL) {
+        fprintf(stderr, "malloc() failed for a batch of workloads.\n");
+        exit(-1);
+    }
+    for (i = 0; i < n; i++) {
+        if (batch_supports(cfg, workloads[i])) queue[queued++] = i;
+        else run_single(workloads[i], cfg, &results[i]);
+    }
+    if (queued > 0) run_lanes(workloads, queue, queued, cfg->policy == POLICY_RR ? cfg->quantum : 0, results);
+    free(queue);
+}
@@ -0,0 +1,44 @@
+/**
+ * batch.h
+ * Batch mode: simulates many small workloads under one configuration, for scoring thousands of
+ * them at once. Workloads of up to BATCH_MAX_THREADS threads under FCFS or RR on one core are packed
+ * into BATCH_LANES lanes of structure-of-arrays buffers (one slot per thread, the same slot of every
+ * lane side by side) and advanced in lockstep: each step, every lane picks the first of its queued
+ * threads and runs it for one slice, and a lane whose workload has finished takes the next one.
+ * Picking the first thread is a scan of the slots of all the lanes with SIMD compares (GCC vector
+ * extensions), and the lanes' clocks, switch costs and burst cursors are updated as vectors too, so
+ * there is no heap and no per-thread pointer to follow.
+ *
+ * Threads are kept in each lane sorted by (process, thread), so the first slot with the lowest
+ * arrival time is the thread the engine's heap would pop, and the results are exactly those of
+ * run_simulation. Workloads the kernel does not cover (other policies, more threads) are run by
+ * run_simulation one after another.
+ */
+
+#ifndef BATCH_H
+#define BATCH_H
+
+#include "engine.h"
+#include "loader.h"
+
+// workloads advanced together, one per 32-bit lane of a SIMD register: 256-bit with AVX2 (-mavx2),
+// otherwise the 128-bit SSE2 every x86-64 CPU has, as wider vectors would be split up and run slower
+#ifdef __AVX2__
+#define BATCH_LANES 8
+#else
+#define BATCH_LANES 4
+#endif
+#define BATCH_MAX_THREADS 256 // larger workloads go to run_simulation, as a scan per step would cost more than a heap
+
+typedef struct batch_result_struct {
+    int time_total;
+    int cpu_time_total;
+    long turnaround_total; // sum over the processes, as report_turnaround_total
+    long dispatches;
+    int threads;
+} BatchResult;
+
+bool batch_supports(const SimConfig *cfg, const Workload *w);
+void run_batch(Workload *const *workloads, int n, const SimConfig *cfg, BatchResult *results);
+
+#endif
@@ -0,0 +1,142 @@
+/**
+ * batch_bench.c
+ * Benchmark for batch mode (batch.c): simulates many small synthetic workloads held in memory under
+ * FCFS and RR, in lockstep with run_batch and one after another with run_simulation, and prints how
+ * many workloads each gets through per second on one core. The two must give the same results.
+ * Usage: "./batch_bench [workloads] [threads_per_workload]" (default 10000 and 8)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bench.h"
+#include "../batch.h"
+
+#define BENCH_PROCESSES 4
+#define BENCH_BURSTS 5
+#define BENCH_QUANTUM 10
+
+// fills the workload with threads spread over BENCH_PROCESSES processes, arriving over time
+static void build_workload(Workload *w, int num_threads, unsigned int *state) {
+    int i, j, index;
+    memset(w, 0, sizeof(Workload));
+    arena_init(&w->arena);
+    pool_init(&w->burst_pool);
+    w->num_processes = BENCH_PROCESSES;
+    w->units_same_switch = 1 + (int)(next_rand(state) % 3);
+    w->units_diff_switch = 4 + (int)(next_rand(state) % 5);
+    for (i = 0; i < num_threads; i++) {
+        Thread *t = add_thread(&w->threads, &index);
+        t->process_num = 1 + i % BENCH_PROCESSES;
+        t->num_threads = (num_threads + BENCH_PROCESSES - 1) / BENCH_PROCESSES;
+        t->thread_num = 1 + i / BENCH_PROCESSES;
+        t->original_arrival_time = (int)(next_rand(state) % (unsigned int)(num_threads * 20));
+        t->burst_num = BENCH_BURSTS;
+        t->cpu_burst_times = arena_alloc(&w->arena, 2 * BENCH_BURSTS * sizeof(int));
+        t->io_burst_times = t->cpu_burst_times + BENCH_BURSTS;
+        t->service_time = 0;
+        t->io_time = 0;
+        for (j = 0; j < BENCH_BURSTS; j++) {
+            t->cpu_burst_times[j] = 1 + (int)(next_rand(state) % 50);
+            t->io_burst_times[j] = j < BENCH_BURSTS - 1 ? (int)(next_rand(state) % 100) : 0;
+            t->service_time += t->cpu_burst_times[j];
+            t->io_time += t->io_burst_times[j];
+        }
+        reset_thread(t);
+    }
+}
+
+// the engine's results for every workload, one after another
+static void run_each(Workload **workloads, int n, const SimConfig *cfg, BatchResult *results) {
+    int i;
+    for (i = 0; i < n; i++) {
+        Report report;
+        SimResult res;
+        reset_workload(workloads[i]);
+        report_init(&report, false);
+        run_simulation(workloads[i], NULL, cfg, &report, &res);
+        results[i].time_total = res.time_total;
+        results[i].cpu_time_total = res.cpu_time_total;
+        results[i].turnaround_total = report_turnaround_total(&report);
+        results[i].dispatches = res.dispatches;
+        results[i].threads = res.threads_read;
+        report_free(&report);
+        free_sim_result(&res);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    int n = 10000;
+    int num_threads = 8;
+    int i, p;
+    if (argc > 1) n = atoi(argv[1]);
+    if (argc > 2) num_threads = atoi(argv[2]);
+    if (n <= 0 || num_threads <= 0 || num_threads > BATCH_MAX_THREADS) {
+        fprintf(stderr, "Usage: ./batch_bench [workloads] [threads_per_workload]\n");
+        exit(-1);
+    }
+    Workload *storage = malloc(n * sizeof(Workload));
+    Workload **workloads = malloc(n * sizeof(Workload *));
+    BatchResult *batch = malloc(n * sizeof(BatchResult));
+    BatchResult *engine = malloc(n * sizeof(BatchResult));
+    if (storage == NULL || workloads == NULL || batch == NULL || engine == NULL) {
+        fprintf(stderr, "malloc() failed for the workloads.\n");
+        exit(-1);
+    }
+    unsigned int state = 2463534242u;
+    for (i = 0; i < n; i++) {
+        build_workload(&storage[i], num_threads, &state);
+        workloads[i] = &storage[i];
+    }
+    printf("# workloads: %d, threads per workload: %d, bursts per thread: %d, quantum: %d, lanes: %d\n", n,
+            num_threads, BENCH_BURSTS, BENCH_QUANTUM, BATCH_LANES);
+
+    PolicyKind policies[] = {POLICY_FCFS, POLICY_RR};
+    for (p = 0; p < 2; p++) {
+        SimConfig cfg;
+        memset(&cfg, 0, sizeof(SimConfig));
+        cfg.policy = policies[p];
+        cfg.quantum = BENCH_QUANTUM;
+        cfg.cores = 1;
+
+        int runs = 0;
+        double start = now_seconds();
+        double seconds;
+        do {
+            run_batch(workloads, n, &cfg, batch);
+            runs++;
+        } while ((seconds = now_seconds() - start) < BENCH_MIN_SECONDS);
+        double batch_rate = (double)n * runs / seconds;
+
+        runs = 0;
+        start = now_seconds();
+        do {
+            run_each(workloads, n, &cfg, engine);
+            runs++;
+        } while ((seconds = now_seconds() - start) < BENCH_MIN_SECONDS);
+        double engine_rate = (double)n * runs / seconds;
+
+        for (i = 0; i < n; i++) {
+            if (batch[i].time_total != engine[i].time_total || batch[i].cpu_time_total != engine[i].cpu_time_total
+                    || batch[i].turnaround_total != engine[i].turnaround_total || batch[i].dispatches != engine[i].dispatches
+                    || batch[i].threads != engine[i].threads) {
+                fprintf(stderr, "ERROR: batch and engine results differ for workload %d under %s\n", i, policy_name(cfg.policy));
+                exit(-1);
+            }
+        }
+        char name[64];
+        printf("# %s: %.0f workloads/s in lockstep, %.0f one after another (%.2fx)\n", policy_name(cfg.policy),
+                batch_rate, engine_rate, batch_rate / engine_rate);
+        snprintf(name, sizeof(name), "batch_%s", policy_name(cfg.policy));
+        bench_result(name, batch_rate / 1e3, "kworkloads/s");
+        snprintf(name, sizeof(name), "batch_engine_%s", policy_name(cfg.policy));
+        bench_result(name, engine_rate / 1e3, "kworkloads/s");
+    }
+
+    for (i = 0; i < n; i++) free_workload(&storage[i]);
+    free(storage);
+    free(workloads);
+    free(batch);
+    free(engine);
+    return 0;
+}
@@ -0,0 +1,36 @@
+/**
+ * bench.h
+ * Helpers shared by the benchmarks. Every benchmark prints its results as lines of
+ * "name<TAB>value<TAB>unit", where a higher value is better, and anything else on lines starting
+ * with '#', so bench/run.sh can collect and compare the results of all of them.
+ */
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdio.h>
+#include <time.h>
+
+#define BENCH_MIN_SECONDS 0.5 // repeat short runs until they take at least this long
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// small deterministic generator so runs are comparable
+static unsigned int next_rand(unsigned int *state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return *state;
+}
+
+// prints one result
+static void bench_result(const char *name, double value, const char *unit) {
+    printf("%s\t%.3f\t%s\n", name, value, unit);
+    fflush(stdout);
+}
+
+#endif
@@ -0,0 +1,94 @@
+/**
+ * event_bench.c
+ * Benchmark for the events queue: the heap (heap.c) against the calendar queue (calqueue.c) in a
+ * hold model shaped like an I/O heavy simulation. Each step takes the first thread and puts it back
+ * a random I/O time later (exponential, mean 1000 time units, with one in 20 much longer), so the
+ * queue always holds the same number of threads. Both queues see the same steps, and must give the
+ * threads back in the same order.
+ * Usage: "./event_bench [steps]" (default 2000000, for each queue at 1000, 100000 and 1000000 threads)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "bench.h"
+#include "../heap.h"
+#include "../calqueue.h"
+
+#define IO_MEAN 1000.0
+
+// random I/O time
+static int io_time(unsigned int *state) {
+    double u = (next_rand(state) + 1.0) / 4294967297.0;
+    double mean = next_rand(state) % 20 == 0 ? 50 * IO_MEAN : IO_MEAN;
+    return (int)(-mean * log(u));
+}
+
+static HeapNode thread_node(int key, int index) {
+    HeapNode node;
+    node.key = key;
+    node.process_num = 1 + index % 64;
+    node.thread_num = 1 + index / 64;
+    node.index = index;
+    return node;
+}
+
+// runs the hold model on one of the queues, returns a checksum of the order threads came out in
+static unsigned long hold(int use_calendar, int threads, long steps, double *seconds) {
+    unsigned int state = 2463534242u;
+    unsigned long checksum = 0;
+    int *keys = malloc(threads * sizeof(int));
+    if (keys == NULL) {
+        fprintf(stderr, "malloc() failed for benchmark keys.\n");
+        exit(-1);
+    }
+    PriorityQueue *heap = use_calendar ? NULL : CreateHeap(threads);
+    CalendarQueue *cal = use_calendar ? calqueue_create() : NULL;
+    int i;
+    long step;
+    for (i = 0; i < threads; i++) {
+        keys[i] = io_time(&state);
+        if (use_calendar) calqueue_insert(cal, thread_node(keys[i], i));
+        else insert(heap, thread_node(keys[i], i));
+    }
+    double start = now_seconds();
+    for (step = 0; step < steps; step++) {
+        int index = use_calendar ? calqueue_pop(cal) : PopMin(heap);
+        checksum = checksum * 31 + index;
+        keys[index] += io_time(&state);
+        if (use_calendar) calqueue_insert(cal, thread_node(keys[index], index));
+        else insert(heap, thread_node(keys[index], index));
+    }
+    *seconds = now_seconds() - start;
+    if (use_calendar) calqueue_free(cal);
+    else FreeHeap(heap);
+    free(keys);
+    return checksum;
+}
+
+int main(int argc, char *argv[]) {
+    long steps = 2000000;
+    int sizes[] = { 1000, 100000, 1000000 };
+    int i;
+    if (argc > 1) steps = atol(argv[1]);
+    if (steps <= 0) {
+        fprintf(stderr, "Usage: ./event_bench [steps]\n");
+        exit(-1);
+    }
+    for (i = 0; i < (int)(sizeof(sizes) / sizeof(sizes[0])); i++) {
+        double heap_seconds, calendar_seconds;
+        char name[64];
+        unsigned long heap_order = hold(0, sizes[i], steps, &heap_seconds);
+        unsigned long calendar_order = hold(1, sizes[i], steps, &calendar_seconds);
+        if (heap_order != calendar_order) {
+            fprintf(stderr, "ERROR: the queues gave %d threads back in different orders\n", sizes[i]);
+            exit(-1);
+        }
+        printf("# %d threads, %ld steps\n", sizes[i], steps);
+        snprintf(name, sizeof(name), "events_heap_%d", sizes[i]);
+        bench_result(name, steps / heap_seconds / 1e6, "Mops/s");
+        snprintf(name, sizeof(name), "events_calendar_%d", sizes[i]);
+        bench_result(name, steps / calendar_seconds / 1e6, "Mops/s");
+    }
+    return 0;
+}
@@ -0,0 +1,77 @@
+/**
+ * heap_bench.c
+ * Microbenchmark for the ready queue (heap.c).
+ * Usage: "./heap_bench [entries]" (default 1000000)
+ * Pushes the given number of random keys, pops them all back out while checking the order,
+ * then runs a hold model (pop one, push one) at full size, printing throughput for each phase.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "bench.h"
+#include "../heap.h"
+
+static HeapNode random_node(unsigned int *state, int index, int time_base) {
+    HeapNode node;
+    node.key = time_base + (int)(next_rand(state) % 1000000);
+    node.process_num = (int)(next_rand(state) % 64);
+    node.thread_num = (int)(next_rand(state) % 16);
+    node.index = index;
+    return node;
+}
+
+int main(int argc, char *argv[]) {
+    int n = 1000000;
+    int i;
+    unsigned int state = 2463534242u;
+    if (argc > 1) n = atoi(argv[1]);
+    if (n <= 0) {
+        fprintf(stderr, "Usage: ./heap_bench [entries]\n");
+        exit(-1);
+    }
+    HeapNode *keys = malloc(n * sizeof(HeapNode));
+    if (keys == NULL) {
+        fprintf(stderr, "malloc() failed for benchmark keys.\n");
+        exit(-1);
+    }
+    for (i = 0; i < n; i++) keys[i] = random_node(&state, i, 0);
+
+    // start small so the growth path is part of the measurement
+    PriorityQueue *pq = CreateHeap(16);
+    double start = now_seconds();
+    for (i = 0; i < n; i++) insert(pq, keys[i]);
+    double push_time = now_seconds() - start;
+
+    start = now_seconds();
+    int prev = -1;
+    int out_of_order = 0;
+    for (i = 0; i < n; i++) {
+        int index = PopMin(pq);
+        if (keys[index].key < prev) out_of_order++;
+        prev = keys[index].key;
+    }
+    double pop_time = now_seconds() - start;
+
+    // hold model: the queue stays full while every popped entry is pushed back later in time
+    for (i = 0; i < n; i++) insert(pq, keys[i]);
+    start = now_seconds();
+    for (i = 0; i < n; i++) {
+        int index = PopMin(pq);
+        keys[index].key += 1 + (int)(next_rand(&state) % 1000);
+        insert(pq, keys[index]);
+    }
+    double hold_time = now_seconds() - start;
+
+    printf("# entries: %d\n", n);
+    bench_result("queue_push", n / push_time / 1e6, "Mops/s");
+    bench_result("queue_pop", n / pop_time / 1e6, "Mops/s");
+    bench_result("queue_hold", n / hold_time / 1e6, "Mops/s"); // pop + push pairs
+    if (out_of_order > 0) {
+        fprintf(stderr, "ERROR: %d keys popped out of order\n", out_of_order);
+        exit(-1);
+    }
+
+    FreeHeap(pq);
+    free(keys);
+    return 0;
+}
@@ -0,0 +1,43 @@
+/**
+ * ingest_bench.c
+ * Benchmark for reading input (loader.c): loads the same workload file over and over and prints
+ * how many megabytes of input are read per second.
+ * Usage: "./ingest_bench name input_file" (results are reported as "ingest_<name>")
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "bench.h"
+#include "../loader.h"
+
+int main(int argc, char *argv[]) {
+    if (argc != 3) {
+        fprintf(stderr, "Usage: ./ingest_bench name input_file\n");
+        exit(-1);
+    }
+    size_t bytes = 0;
+    long loads = 0;
+    long threads = 0;
+    int binary = 0;
+    double start = now_seconds();
+    double seconds = 0;
+    // small files are loaded until the total is long enough to time
+    while (loads == 0 || seconds < BENCH_MIN_SECONDS) {
+        Workload w;
+        LoadStats stats;
+        load_workload(argv[2], &w, &stats);
+        bytes += stats.bytes;
+        threads = w.threads.count;
+        binary = stats.binary;
+        free_workload(&w);
+        loads++;
+        seconds = now_seconds() - start;
+    }
+
+    char name[256];
+    snprintf(name, sizeof(name), "ingest_%s", argv[1]);
+    printf("# %s: %ld threads, %ld loads of %zu bytes (%s) in %.3f s\n", argv[2], threads, loads,
+           bytes / loads, binary ? "binary" : "text", seconds);
+    bench_result(name, bytes / seconds / 1e6, "MB/s");
+    return 0;
+}
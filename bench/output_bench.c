@@ -0,0 +1,94 @@
+/**
+ * output_bench.c
+ * Benchmark for the verbose and detailed output path (output.c): writes the same random state
+ * transitions in every output format to /dev/null and prints how many lines per second each
+ * manages, next to one fprintf per line as the simulator used to.
+ * Usage: "./output_bench [transitions]" (default 2000000)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "bench.h"
+#include "../simcpu.h"
+#include "../output.h"
+
+static const char *states[] = {STATE_NEW, STATE_READY, STATE_RUNNING, STATE_BLOCKED, STATE_TERMINATED};
+
+typedef struct transition_struct {
+    int time;
+    int process_num;
+    int thread_num;
+    int state1;
+    int state2;
+} Transition;
+
+// rate of lines per second of one way of writing them all, repeated for at least BENCH_MIN_SECONDS
+static double measure(const Transition *lines, int n, FILE *sink, int format) {
+    int i;
+    long written = 0;
+    double start = now_seconds();
+    double seconds;
+    do {
+        if (format < 0) {
+            for (i = 0; i < n; i++) {
+                fprintf(sink, "At time %d: Thread %d of Process %d moves from %s to %s\n", lines[i].time,
+                        lines[i].thread_num, lines[i].process_num, states[lines[i].state1], states[lines[i].state2]);
+            }
+            fflush(sink);
+        } else {
+            OutputWriter out;
+            output_init(&out, sink, (OutputFormat)format);
+            for (i = 0; i < n; i++) {
+                output_transition(&out, lines[i].time, lines[i].process_num, lines[i].thread_num, lines[i].state1,
+                        lines[i].state2);
+            }
+            output_finish(&out);
+            fflush(sink);
+        }
+        written += n;
+        seconds = now_seconds() - start;
+    } while (seconds < BENCH_MIN_SECONDS);
+    return written / seconds;
+}
+
+int main(int argc, char *argv[]) {
+    int n = 2000000;
+    int i, format;
+    unsigned int state = 2463534242u;
+    if (argc > 1) n = atoi(argv[1]);
+    if (n <= 0) {
+        fprintf(stderr, "Usage: ./output_bench [transitions]\n");
+        exit(-1);
+    }
+    Transition *lines = malloc(n * sizeof(Transition));
+    if (lines == NULL) {
+        fprintf(stderr, "malloc() failed for benchmark transitions.\n");
+        exit(-1);
+    }
+    int time = 0;
+    for (i = 0; i < n; i++) {
+        time += (int)(next_rand(&state) % 20);
+        lines[i].time = time;
+        lines[i].process_num = 1 + (int)(next_rand(&state) % 1000);
+        lines[i].thread_num = 1 + (int)(next_rand(&state) % 100);
+        lines[i].state1 = 1 + (int)(next_rand(&state) % 3); // READY, RUNNING or BLOCKED
+        lines[i].state2 = lines[i].state1 == RUNNING_NUM ? BLOCKED_NUM : RUNNING_NUM;
+    }
+    FILE *sink = fopen("/dev/null", "w");
+    if (sink == NULL) {
+        perror("/dev/null");
+        exit(-1);
+    }
+
+    printf("# transitions: %d\n", n);
+    bench_result("output_fprintf", measure(lines, n, sink, -1) / 1e6, "Mlines/s");
+    for (format = 0; format < NUM_FORMATS; format++) {
+        char name[64];
+        snprintf(name, sizeof(name), "output_%s", output_format_name((OutputFormat)format));
+        bench_result(name, measure(lines, n, sink, format) / 1e6, "Mlines/s");
+    }
+
+    fclose(sink);
+    free(lines);
+    return 0;
+}
@@ -0,0 +1,84 @@
+/**
+ * policy_bench.c
+ * Benchmark for the simulation engine (engine.c): runs every scheduling policy on the same
+ * synthetic workload held in memory and prints how many scheduling events (dispatches) each
+ * simulates per second.
+ * Usage: "./policy_bench [threads] [bursts_per_thread]" (default 100000 and 10)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bench.h"
+#include "../engine.h"
+
+#define BENCH_PROCESSES 64
+#define BENCH_QUANTUM 10
+
+// fills the workload with threads spread over BENCH_PROCESSES processes, arriving over time
+static void build_workload(Workload *w, int num_threads, int bursts) {
+    unsigned int state = 2463534242u;
+    int i, j, index;
+    memset(w, 0, sizeof(Workload));
+    arena_init(&w->arena);
+    pool_init(&w->burst_pool);
+    w->num_processes = BENCH_PROCESSES;
+    w->units_same_switch = 3;
+    w->units_diff_switch = 7;
+    for (i = 0; i < num_threads; i++) {
+        Thread *t = add_thread(&w->threads, &index);
+        t->process_num = 1 + i % BENCH_PROCESSES;
+        t->num_threads = (num_threads + BENCH_PROCESSES - 1) / BENCH_PROCESSES;
+        t->thread_num = 1 + i / BENCH_PROCESSES;
+        t->original_arrival_time = (int)(next_rand(&state) % (unsigned int)(num_threads * 10));
+        t->burst_num = bursts;
+        t->cpu_burst_times = arena_alloc(&w->arena, 2 * (size_t)bursts * sizeof(int));
+        t->io_burst_times = t->cpu_burst_times + bursts;
+        t->service_time = 0;
+        t->io_time = 0;
+        for (j = 0; j < bursts; j++) {
+            t->cpu_burst_times[j] = 1 + (int)(next_rand(&state) % 50);
+            t->io_burst_times[j] = j < bursts - 1 ? (int)(next_rand(&state) % 200) : 0;
+            t->service_time += t->cpu_burst_times[j];
+            t->io_time += t->io_burst_times[j];
+        }
+        reset_thread(t);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    int num_threads = 100000;
+    int bursts = 10;
+    int policy;
+    if (argc > 1) num_threads = atoi(argv[1]);
+    if (argc > 2) bursts = atoi(argv[2]);
+    if (num_threads <= 0 || bursts <= 0) {
+        fprintf(stderr, "Usage: ./policy_bench [threads] [bursts_per_thread]\n");
+        exit(-1);
+    }
+    Workload w;
+    build_workload(&w, num_threads, bursts);
+    printf("# threads: %d, bursts per thread: %d, quantum: %d\n", num_threads, bursts, BENCH_QUANTUM);
+
+    for (policy = 0; policy < NUM_POLICIES; policy++) {
+        SimConfig cfg;
+        SimResult res;
+        Report report;
+        memset(&cfg, 0, sizeof(SimConfig));
+        cfg.policy = policy;
+        cfg.quantum = BENCH_QUANTUM;
+        reset_workload(&w);
+        report_init(&report, false);
+        double start = now_seconds();
+        run_simulation(&w, NULL, &cfg, &report, &res);
+        double seconds = now_seconds() - start;
+        char name[64];
+        snprintf(name, sizeof(name), "policy_%s", policy_name(policy));
+        printf("# %s: %ld events in %.3f s (total time %d units)\n", policy_name(policy), res.dispatches, seconds, res.time_total);
+        bench_result(name, res.dispatches / seconds / 1e6, "Mevents/s");
+        report_free(&report);
+    }
+
+    free_workload(&w);
+    return 0;
+}
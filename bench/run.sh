@@ -0,0 +1,72 @@
+#!/bin/sh
+# run.sh
+# Runs every benchmark on small, medium and huge generated workloads and writes the results to a
+# tab separated file ("name value unit", higher is better). With --compare, each result is also
+# checked against the same name in a baseline file, and any that dropped by more than the
+# threshold is reported as a regression (exit status 1).
+# Usage: "sh bench/run.sh [-o results_file] [--compare baseline_file] [--threshold percent]"
+# (run from the top directory after "make bench"; defaults: bench/results.tsv and 10 percent)
+
+results=bench/results.tsv
+baseline=
+threshold=10
+while [ $# -gt 0 ]; do
+    case "$1" in
+        -o) results="$2"; shift 2 ;;
+        --compare) baseline="$2"; shift 2 ;;
+        --threshold) threshold="$2"; shift 2 ;;
+        *) echo "Usage: sh bench/run.sh [-o results_file] [--compare baseline_file] [--threshold percent]" >&2; exit 255 ;;
+    esac
+done
+if [ -n "$baseline" ] && [ ! -r "$baseline" ]; then
+    echo "ERROR: cannot read baseline $baseline" >&2
+    exit 255
+fi
+
+set -e
+dir="${TMPDIR:-/tmp}/simcpu-bench"
+mkdir -p "$dir"
+
+# same seed every time, so every run measures the same workloads
+./simgen -s 1 -p 10 -t 10 -o "$dir/small.txt"
+./simgen -s 1 -p 100 -t 100 -o "$dir/medium.txt"
+./simgen -s 1 -p 500 -t 400 -o "$dir/huge.txt"
+./simgen -s 1 -p 500 -t 400 --binary -o "$dir/huge.bin"
+# I/O heavy: short CPU bursts and long I/O, so most threads are waiting in the events queue
+./simgen -s 1 -p 200 -t 200 -b 5:20 --cpu exp:5 --io exp:5000 --gap 1 -o "$dir/io.txt"
+
+{
+    for size in small medium huge; do
+        ./ingest_bench "$size" "$dir/$size.txt"
+    done
+    ./ingest_bench huge_binary "$dir/huge.bin"
+    ./heap_bench
+    ./event_bench
+    for size in small medium huge; do
+        ./sim_bench "$size" "$dir/$size.txt"
+    done
+    ./sim_bench io "$dir/io.txt"
+    ./sim_bench_calendar io "$dir/io.txt"
+    ./policy_bench
+    ./output_bench
+    ./batch_bench
+    ./sample_bench
+} | tee "$dir/output.txt" | grep -v '^#' > "$results"
+grep '^#' "$dir/output.txt" || true
+cat "$results"
+echo "# results written to $results"
+
+if [ -n "$baseline" ]; then
+    awk -F '\t' -v threshold="$threshold" '
+        NR == FNR { base[$1] = $2; next }
+        ($1 in base) && base[$1] > 0 {
+            change = ($2 - base[$1]) / base[$1] * 100
+            flag = change < -threshold ? "  REGRESSION" : ""
+            if (flag != "") regressions++
+            printf("%-24s %12.3f -> %12.3f %s (%+.1f%%)%s\n", $1, base[$1], $2, $3, change, flag)
+        }
+        END {
+            if (regressions > 0) { printf("%d regression(s) over %s%%\n", regressions, threshold); exit 1 }
+            printf("no regressions over %s%%\n", threshold)
+        }' "$baseline" "$results"
+fi
@@ -0,0 +1,136 @@
+/**
+ * sample_bench.c
+ * Benchmark for sampled mode (sample.c): simulates long synthetic workloads held in memory at a few
+ * loads under FCFS and RR, exactly with run_simulation and sampled with run_sampled, and prints the
+ * error of each estimate against the exact result, whether it is inside the estimate's interval,
+ * whether sampling gave up for a full run, and how much faster the sampled run is (measured at the
+ * middle load).
+ * Usage: "./sample_bench [processes] [rate]" (default 20000 and 0.05)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "bench.h"
+#include "../sample.h"
+
+#define BENCH_THREADS 4 // per process
+#define BENCH_BURSTS 4
+#define BENCH_QUANTUM 10
+#define BENCH_PROCESS_CPU (BENCH_THREADS * BENCH_BURSTS * 25) // average CPU time per process
+
+// fills the workload with processes arriving on average every BENCH_PROCESS_CPU / load units, each
+// with BENCH_THREADS threads arriving together
+static void build_workload(Workload *w, int num_processes, double load) {
+    unsigned int state = 2463534242u;
+    int gap = (int)(BENCH_PROCESS_CPU / load + 0.5);
+    int arrival = 0;
+    int i, j, k, index;
+    memset(w, 0, sizeof(Workload));
+    arena_init(&w->arena);
+    pool_init(&w->burst_pool);
+    w->num_processes = num_processes;
+    w->units_same_switch = 3;
+    w->units_diff_switch = 7;
+    for (i = 0; i < num_processes; i++) {
+        arrival += (int)(next_rand(&state) % (unsigned int)(2 * gap));
+        for (k = 0; k < BENCH_THREADS; k++) {
+            Thread *t = add_thread(&w->threads, &index);
+            t->process_num = 1 + i;
+            t->num_threads = BENCH_THREADS;
+            t->thread_num = 1 + k;
+            t->original_arrival_time = arrival + (int)(next_rand(&state) % 10);
+            t->burst_num = BENCH_BURSTS;
+            t->cpu_burst_times = arena_alloc(&w->arena, 2 * BENCH_BURSTS * sizeof(int));
+            t->io_burst_times = t->cpu_burst_times + BENCH_BURSTS;
+            t->service_time = 0;
+            t->io_time = 0;
+            for (j = 0; j < BENCH_BURSTS; j++) {
+                t->cpu_burst_times[j] = 1 + (int)(next_rand(&state) % 49);
+                t->io_burst_times[j] = j < BENCH_BURSTS - 1 ? (int)(next_rand(&state) % 100) : 0;
+                t->service_time += t->cpu_burst_times[j];
+                t->io_time += t->io_burst_times[j];
+            }
+            reset_thread(t);
+        }
+    }
+}
+
+// prints an estimate against the exact value; returns whether the exact value is inside its interval
+static bool compare(const char *name, Estimate e, double exact) {
+    bool inside = fabs(e.value - exact) <= e.error;
+    printf("#   %-20s exact %12.1f, sampled %12.1f +/- %-10.1f (error %+.2f%%%s)\n", name, exact, e.value, e.error,
+            exact != 0 ? 100 * (e.value - exact) / fabs(exact) : 0.0, inside ? "" : ", outside the interval");
+    return inside;
+}
+
+int main(int argc, char *argv[]) {
+    int num_processes = 20000;
+    double rate = 0.05;
+    int l, p;
+    if (argc > 1) num_processes = atoi(argv[1]);
+    if (argc > 2) rate = atof(argv[2]);
+    if (num_processes < 2 || rate <= 0 || rate >= 1) {
+        fprintf(stderr, "Usage: ./sample_bench [processes] [rate]\n");
+        exit(-1);
+    }
+    SampleSpec spec = {rate, SAMPLE_DEFAULT_WINDOWS};
+    printf("# processes: %d, threads per process: %d, bursts per thread: %d, rate: %.3f, windows: %d\n",
+            num_processes, BENCH_THREADS, BENCH_BURSTS, rate, spec.windows);
+
+    double loads[] = {0.3, 0.6, 0.9};
+    int inside = 0;
+    int estimates = 0;
+    int exact_runs = 0;
+    for (l = 0; l < 3; l++) {
+        Workload w;
+        build_workload(&w, num_processes, loads[l]);
+        PolicyKind policies[] = {POLICY_FCFS, POLICY_RR};
+        for (p = 0; p < 2; p++) {
+            SimConfig cfg;
+            memset(&cfg, 0, sizeof(SimConfig));
+            cfg.policy = policies[p];
+            cfg.quantum = BENCH_QUANTUM;
+            cfg.cores = 1;
+
+            Report report;
+            SimResult exact;
+            double start = now_seconds();
+            reset_workload(&w);
+            report_init(&report, false);
+            run_simulation(&w, NULL, &cfg, &report, &exact);
+            double exact_seconds = now_seconds() - start;
+
+            SampleResult sampled;
+            start = now_seconds();
+            run_sampled(&w, &cfg, &spec, &sampled);
+            double sampled_seconds = now_seconds() - start;
+
+            printf("# load %.1f, %s: %d of %d windows sampled, %.1f%% of the CPU time simulated, %.1fx faster%s\n",
+                    loads[l], policy_name(cfg.policy), sampled.windows_sampled, sampled.windows,
+                    100 * (double)sampled.cpu_time_simulated / (double)sampled.cpu_time_total, exact_seconds / sampled_seconds,
+                    !sampled.exact ? "" : sampled.windows_truncated > 0 ? " (a window cut short, then run in full)"
+                    : " (too much to simulate, then run in full)");
+            exact_runs += sampled.exact;
+            inside += compare("total time", sampled.time_total, exact.time_total);
+            inside += compare("average turnaround", sampled.average_turnaround,
+                    (double)report_turnaround_total(&report) / (double)w.num_processes);
+            inside += compare("cpu utilization", sampled.cpu_utilization,
+                    100 * (double)exact.cpu_time_total / (double)exact.time_total);
+            estimates += 3;
+
+            if (l == 1) {
+                char name[64];
+                snprintf(name, sizeof(name), "sample_speedup_%s", policy_name(cfg.policy));
+                bench_result(name, exact_seconds / sampled_seconds, "x");
+            }
+            report_free(&report);
+            free_sim_result(&exact);
+        }
+        free_workload(&w);
+    }
+    printf("# %d of %d exact results inside the 95%% intervals, %d of %d runs simulated in full\n", inside, estimates,
+            exact_runs, estimates / 3);
+    return 0;
+}
@@ -0,0 +1,60 @@
+/**
+ * sim_bench.c
+ * End to end benchmark: loads a workload file once, then simulates it with FCFS and with round
+ * robin, printing how many scheduling events (dispatches) are simulated per second. Input is
+ * not part of the measurement (see ingest_bench.c).
+ * Usage: "./sim_bench name input_file [quantum]" (default quantum 10, results are reported as
+ * "sim_<policy>_<name>", with "_calendar" appended when built with the calendar events queue)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bench.h"
+#include "../engine.h"
+
+int main(int argc, char *argv[]) {
+    int quantum = 10;
+    if (argc > 3) quantum = atoi(argv[3]);
+    if (argc < 3 || argc > 4 || quantum <= 0) {
+        fprintf(stderr, "Usage: ./sim_bench name input_file [quantum]\n");
+        exit(-1);
+    }
+    Workload w;
+    load_workload(argv[2], &w, NULL);
+    printf("# %s: %d threads, quantum: %d\n", argv[2], w.threads.count, quantum);
+
+    PolicyKind policies[] = { POLICY_FCFS, POLICY_RR };
+    int i;
+    for (i = 0; i < (int)(sizeof(policies) / sizeof(policies[0])); i++) {
+        SimConfig cfg;
+        memset(&cfg, 0, sizeof(SimConfig));
+        cfg.policy = policies[i];
+        cfg.quantum = quantum;
+        long events = 0;
+        long runs = 0;
+        double seconds = 0;
+        // small workloads are simulated until the total is long enough to time
+        while (runs == 0 || seconds < BENCH_MIN_SECONDS) {
+            SimResult res;
+            Report report;
+            reset_workload(&w);
+            report_init(&report, false);
+            double start = now_seconds();
+            run_simulation(&w, NULL, &cfg, &report, &res);
+            seconds += now_seconds() - start;
+            events += res.dispatches;
+            runs++;
+            report_free(&report);
+            free_sim_result(&res);
+        }
+        char name[256];
+        snprintf(name, sizeof(name), "sim_%s_%s%s", policy_name(policies[i]), argv[1],
+                strcmp(event_queue_name(), "heap") == 0 ? "" : "_calendar");
+        printf("# %s: %ld runs, %ld events in %.3f s\n", policy_name(policies[i]), runs, events, seconds);
+        bench_result(name, events / seconds / 1e6, "Mevents/s");
+    }
+
+    free_workload(&w);
+    return 0;
+}
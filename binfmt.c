@@ -0,0 +1,192 @@
+/**
+ * binfmt.c
+ * Binary workload format - see binfmt.h
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "binfmt.h"
+
+#define ALIGN8(n) (((n) + 7) & ~(uint64_t)7)
+
+// burst arrays are written and mapped as int32 columns, so int must be 32 bits (fails to compile otherwise)
+typedef char int_is_32_bits[sizeof(int) == sizeof(int32_t) ? 1 : -1];
+
+static void format_error(const char *name, const char *message) {
+    load_error("%s: %s", name, message);
+}
+
+// returns non-zero if the data starts like a binary workload
+int is_binary_workload(const void *data, size_t size) {
+    return size >= BIN_MAGIC_LEN && memcmp(data, BIN_MAGIC, BIN_MAGIC_LEN) == 0;
+}
+
+// returns a pointer to the given column if it lies inside the file, exits otherwise
+static void *column(void *data, size_t size, const BinHeader *h, int col, uint64_t count, size_t elem, const char *name) {
+    uint64_t offset = h->offsets[col];
+    if (offset % 8 != 0 || offset > size || count > (size - offset) / elem) {
+        format_error(name, "column lies outside of the file (truncated or corrupt?)");
+    }
+    return (char *)data + offset;
+}
+
+// Checks the header of a mapped binary file, sets the workload's header values and finds the columns.
+// The mapping must stay valid while the workload is used; the simulation only reads the bursts.
+void open_binary_workload(void *data, size_t size, const char *name, Workload *w, BinColumns *cols) {
+    BinHeader h;
+    if (size < sizeof(BinHeader)) format_error(name, "file is too small for a binary workload");
+    memcpy(&h, data, sizeof(BinHeader));
+    if (h.byte_order != BIN_BYTE_ORDER) format_error(name, "binary workload was written on a machine with a different byte order");
+    if (h.version != BIN_VERSION) format_error(name, "unsupported binary workload version");
+    if (h.header_size != sizeof(BinHeader)) format_error(name, "unexpected binary header size");
+    if (h.num_threads > (uint64_t)INT32_MAX) format_error(name, "too many threads");
+
+    cols->num_threads = h.num_threads;
+    cols->num_bursts = h.num_bursts;
+    cols->process_num = column(data, size, &h, COL_PROCESS_NUM, h.num_threads, sizeof(int32_t), name);
+    cols->thread_num = column(data, size, &h, COL_THREAD_NUM, h.num_threads, sizeof(int32_t), name);
+    cols->num_threads_col = column(data, size, &h, COL_NUM_THREADS, h.num_threads, sizeof(int32_t), name);
+    cols->arrival_time = column(data, size, &h, COL_ARRIVAL_TIME, h.num_threads, sizeof(int32_t), name);
+    cols->burst_num = column(data, size, &h, COL_BURST_NUM, h.num_threads, sizeof(int32_t), name);
+    cols->service_time = column(data, size, &h, COL_SERVICE_TIME, h.num_threads, sizeof(int32_t), name);
+    cols->io_time = column(data, size, &h, COL_IO_TIME, h.num_threads, sizeof(int32_t), name);
+    cols->burst_offset = column(data, size, &h, COL_BURST_OFFSET, h.num_threads, sizeof(int64_t), name);
+    cols->cpu_bursts = column(data, size, &h, COL_CPU_BURSTS, h.num_bursts, sizeof(int32_t), name);
+    cols->io_bursts = column(data, size, &h, COL_IO_BURSTS, h.num_bursts, sizeof(int32_t), name);
+
+    w->num_processes = h.num_processes;
+    w->units_same_switch = h.units_same_switch;
+    w->units_diff_switch = h.units_diff_switch;
+    if (w->num_processes > 0 && (w->units_same_switch < 0 || w->units_diff_switch < 0)) load_error("Invalid first line in input");
+}
+
+// Fills t from thread i of the columns. Its burst pointers point straight into the mapping, so no
+// burst is copied; they are only checked, as the text loader checks them, when the thread is read.
+void read_binary_thread(const BinColumns *cols, uint64_t i, const char *name, Thread *t) {
+    int j;
+    if (cols->burst_num[i] < 1 || cols->burst_offset[i] < 0
+            || (uint64_t)cols->burst_offset[i] + cols->burst_num[i] > cols->num_bursts) {
+        format_error(name, "thread refers to bursts outside of the burst arrays");
+    }
+    if (cols->process_num[i] < 0) format_error(name, "process number cannot be negative");
+    if (cols->arrival_time[i] < 0) format_error(name, "arrival time cannot be negative");
+    for (j = 0; j < cols->burst_num[i]; j++) {
+        if (cols->cpu_bursts[cols->burst_offset[i] + j] < 0 || cols->io_bursts[cols->burst_offset[i] + j] < 0) {
+            format_error(name, "burst times cannot be negative");
+        }
+    }
+    t->process_num = cols->process_num[i];
+    t->thread_num = cols->thread_num[i];
+    t->num_threads = cols->num_threads_col[i];
+    t->arrival_time = cols->arrival_time[i];
+    t->original_arrival_time = cols->arrival_time[i];
+    t->burst_num = cols->burst_num[i];
+    t->service_time = cols->service_time[i];
+    t->io_time = cols->io_time[i];
+    t->cpu_burst_times = cols->cpu_bursts + cols->burst_offset[i];
+    t->io_burst_times = cols->io_bursts + cols->burst_offset[i];
+    reset_thread(t);
+}
+
+// writes one int32 field of every thread as a column
+#define WRITE_THREAD_COLUMN(field) do { \
+        for (i = 0; i < w->threads.count; i++) { \
+            int32_t value = w->threads.arr[i].field; \
+            fwrite(&value, sizeof(value), 1, out); \
+        } \
+    } while (0)
+
+static void pad_to(FILE *out, uint64_t offset) {
+    long pos = ftell(out);
+    while ((uint64_t)pos < offset) {
+        fputc(0, out);
+        pos++;
+    }
+}
+
+// Fills in the header of a binary workload with the given counts, laying the columns out one after
+// another. Returns the size of the whole file.
+uint64_t init_binary_header(BinHeader *h, const Workload *w, uint64_t num_threads, uint64_t num_bursts) {
+    memset(h, 0, sizeof(BinHeader));
+    memcpy(h->magic, BIN_MAGIC, BIN_MAGIC_LEN);
+    h->version = BIN_VERSION;
+    h->byte_order = BIN_BYTE_ORDER;
+    h->num_processes = w->num_processes;
+    h->units_same_switch = w->units_same_switch;
+    h->units_diff_switch = w->units_diff_switch;
+    h->header_size = sizeof(BinHeader);
+    h->num_threads = num_threads;
+    h->num_bursts = num_bursts;
+    uint64_t offset = ALIGN8(sizeof(BinHeader));
+    int col;
+    for (col = 0; col < NUM_BIN_COLUMNS; col++) {
+        h->offsets[col] = offset;
+        if (col == COL_BURST_OFFSET) offset = ALIGN8(offset + num_threads * sizeof(int64_t));
+        else if (col == COL_CPU_BURSTS || col == COL_IO_BURSTS) offset = ALIGN8(offset + num_bursts * sizeof(int32_t));
+        else offset = ALIGN8(offset + num_threads * sizeof(int32_t));
+    }
+    return offset;
+}
+
+// writes the workload to path in the binary format
+void write_binary_workload(const Workload *w, const char *path) {
+    BinHeader h;
+    int i;
+    uint64_t bursts = 0;
+    for (i = 0; i < w->threads.count; i++) {
+        const Thread *t = &w->threads.arr[i];
+        int j;
+        bool negative = t->original_arrival_time < 0;
+        for (j = 0; j < t->burst_num; j++) negative |= t->cpu_burst_times[j] < 0 || t->io_burst_times[j] < 0;
+        if (negative) {
+            fprintf(stderr, "ERROR: %s: thread %d of process %d has a negative arrival or burst time\n", path, t->thread_num,
+                    t->process_num);
+            exit(-1);
+        }
+        bursts += t->burst_num;
+    }
+    init_binary_header(&h, w, w->threads.count, bursts);
+
+    FILE *out = fopen(path, "wb");
+    if (out == NULL) {
+        perror(path);
+        exit(-1);
+    }
+    setvbuf(out, NULL, _IOFBF, 1 << 20);
+    fwrite(&h, sizeof(h), 1, out);
+
+    pad_to(out, h.offsets[COL_PROCESS_NUM]);
+    WRITE_THREAD_COLUMN(process_num);
+    pad_to(out, h.offsets[COL_THREAD_NUM]);
+    WRITE_THREAD_COLUMN(thread_num);
+    pad_to(out, h.offsets[COL_NUM_THREADS]);
+    WRITE_THREAD_COLUMN(num_threads);
+    pad_to(out, h.offsets[COL_ARRIVAL_TIME]);
+    WRITE_THREAD_COLUMN(original_arrival_time);
+    pad_to(out, h.offsets[COL_BURST_NUM]);
+    WRITE_THREAD_COLUMN(burst_num);
+    pad_to(out, h.offsets[COL_SERVICE_TIME]);
+    WRITE_THREAD_COLUMN(service_time);
+    pad_to(out, h.offsets[COL_IO_TIME]);
+    WRITE_THREAD_COLUMN(io_time);
+
+    pad_to(out, h.offsets[COL_BURST_OFFSET]);
+    int64_t first_burst = 0;
+    for (i = 0; i < w->threads.count; i++) {
+        fwrite(&first_burst, sizeof(first_burst), 1, out);
+        first_burst += w->threads.arr[i].burst_num;
+    }
+    pad_to(out, h.offsets[COL_CPU_BURSTS]);
+    for (i = 0; i < w->threads.count; i++) {
+        fwrite(w->threads.arr[i].cpu_burst_times, sizeof(int32_t), w->threads.arr[i].burst_num, out);
+    }
+    pad_to(out, h.offsets[COL_IO_BURSTS]);
+    for (i = 0; i < w->threads.count; i++) {
+        fwrite(w->threads.arr[i].io_burst_times, sizeof(int32_t), w->threads.arr[i].burst_num, out);
+    }
+    if (ferror(out) || fclose(out) != 0) {
+        perror(path);
+        exit(-1);
+    }
+}
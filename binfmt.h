@@ -0,0 +1,83 @@
+/**
+ * binfmt.h
+ * Versioned binary workload format, written by "simcpu --convert" and loaded by memory mapping
+ * the file. Everything after the header is stored in columns (one array per field) so the
+ * burst arrays of the mapped file can be used by the simulator directly, without copying.
+ *
+ * Layout (all integers in host byte order, checked with byte_order):
+ *   BinHeader
+ *   int32  process_num[num_threads]
+ *   int32  thread_num[num_threads]
+ *   int32  num_threads[num_threads]     (threads in the thread's process)
+ *   int32  arrival_time[num_threads]
+ *   int32  burst_num[num_threads]
+ *   int32  service_time[num_threads]    (sum of the thread's CPU bursts)
+ *   int32  io_time[num_threads]         (sum of the thread's I/O bursts)
+ *   int64  burst_offset[num_threads]    (index of the thread's first burst in the burst arrays)
+ *   int32  cpu_burst_times[num_bursts]
+ *   int32  io_burst_times[num_bursts]
+ * Each array starts at the offset recorded for it in the header, aligned to 8 bytes.
+ */
+
+#ifndef BINFMT_H
+#define BINFMT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "loader.h"
+
+#define BIN_MAGIC "SIMCPUWL"
+#define BIN_MAGIC_LEN 8
+#define BIN_VERSION 1
+#define BIN_BYTE_ORDER 0x01020304u
+
+enum bin_column {
+    COL_PROCESS_NUM,
+    COL_THREAD_NUM,
+    COL_NUM_THREADS,
+    COL_ARRIVAL_TIME,
+    COL_BURST_NUM,
+    COL_SERVICE_TIME,
+    COL_IO_TIME,
+    COL_BURST_OFFSET,
+    COL_CPU_BURSTS,
+    COL_IO_BURSTS,
+    NUM_BIN_COLUMNS
+};
+
+typedef struct bin_header_struct {
+    char magic[BIN_MAGIC_LEN];
+    uint32_t version;
+    uint32_t byte_order;
+    int32_t num_processes;
+    int32_t units_same_switch;
+    int32_t units_diff_switch;
+    uint32_t header_size;
+    uint64_t num_threads;
+    uint64_t num_bursts;
+    uint64_t offsets[NUM_BIN_COLUMNS]; // byte offset of each column from the start of the file
+} BinHeader;
+
+// the columns of a mapped binary workload
+typedef struct bin_columns_struct {
+    uint64_t num_threads;
+    uint64_t num_bursts;
+    int32_t *process_num;
+    int32_t *thread_num;
+    int32_t *num_threads_col;
+    int32_t *arrival_time;
+    int32_t *burst_num;
+    int32_t *service_time;
+    int32_t *io_time;
+    int64_t *burst_offset;
+    int32_t *cpu_bursts;
+    int32_t *io_bursts;
+} BinColumns;
+
+int is_binary_workload(const void *data, size_t size);
+void open_binary_workload(void *data, size_t size, const char *name, Workload *w, BinColumns *cols);
+void read_binary_thread(const BinColumns *cols, uint64_t i, const char *name, Thread *t);
+uint64_t init_binary_header(BinHeader *h, const Workload *w, uint64_t num_threads, uint64_t num_bursts);
+void write_binary_workload(const Workload *w, const char *path);
+
+#endif
@@ -0,0 +1,184 @@
+/**
+ * calqueue.c
+ * Calendar queue implementation - see calqueue.h
+ *
+ * SOURCES:
+ * - R. Brown, "Calendar Queues: A Fast O(1) Priority Queue Implementation for the Simulation Event
+ *   Set Problem", Communications of the ACM 31(10), 1988 (bucket width from a sample of the first entries)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "calqueue.h"
+
+#define CALQUEUE_INITIAL_SHIFT 4
+#define CALQUEUE_SAMPLE 25       // first entries whose spacing sets the bucket width
+#define CALQUEUE_MAX_SEARCHES 8  // full searches (nothing within a year) allowed before the width is recalculated
+#define BUCKET_INITIAL_CAPACITY 4
+
+// bucket an entry with this key goes in
+static inline int bucket_of(const CalendarQueue *q, long key) {
+    return (int)((key >> q->shift) & (q->num_buckets - 1));
+}
+
+// end of the time window (one bucket wide) holding this key
+static inline long window_end(const CalendarQueue *q, long key) {
+    return ((key >> q->shift) + 1) << q->shift;
+}
+
+// adds the node to a bucket
+static void bucket_add(CalendarQueue *q, PriorityQueue *b, HeapNode node) {
+    if (b->arr == NULL) {
+        b->arr = malloc(BUCKET_INITIAL_CAPACITY * sizeof(HeapNode));
+        if (b->arr == NULL) {
+            fprintf(stderr, "malloc() failed for a calendar queue bucket.\n");
+            exit(-1);
+        }
+        b->capacity = BUCKET_INITIAL_CAPACITY;
+        q->allocations++;
+    } else if (b->count == b->capacity) {
+        q->allocations++; // insert() doubles it
+    }
+    insert(b, node);
+}
+
+// bucket holding the first entry (the queue must not be empty): the first bucket from the current
+// one whose first entry falls in that bucket's window this year, or if a whole year goes by without
+// one, the bucket with the smallest first entry
+static int locate(CalendarQueue *q) {
+    int b = q->current;
+    long end = q->current_end;
+    long width = 1L << q->shift;
+    int i;
+    for (i = 0; i < q->num_buckets; i++) {
+        PriorityQueue *bucket = &q->buckets[b];
+        if (bucket->count > 0 && bucket->arr[0].key < end) {
+            q->current = b;
+            q->current_end = end;
+            return b;
+        }
+        b = (b + 1) & (q->num_buckets - 1);
+        end += width;
+    }
+    int best = -1;
+    for (b = 0; b < q->num_buckets; b++) {
+        PriorityQueue *bucket = &q->buckets[b];
+        if (bucket->count > 0 && (best == -1 || node_less(&bucket->arr[0], &q->buckets[best].arr[0]))) best = b;
+    }
+    q->current = best;
+    q->current_end = window_end(q, q->buckets[best].arr[0].key);
+    q->searches++;
+    return best;
+}
+
+// removes and returns the first entry (the queue must not be empty)
+static HeapNode take_first(CalendarQueue *q) {
+    PriorityQueue *bucket = &q->buckets[locate(q)];
+    HeapNode node = bucket->arr[0];
+    PopMin(bucket);
+    q->count--;
+    return node;
+}
+
+// bucket width (as a shift) of about three times the average spacing of the sorted sample, leaving
+// out gaps more than twice the average
+static int width_shift(const HeapNode *sample, int n, int shift) {
+    int i;
+    if (n < 2) return shift;
+    double average = (double)(sample[n - 1].key - sample[0].key) / (n - 1);
+    double total = 0;
+    int gaps = 0;
+    for (i = 1; i < n; i++) {
+        int gap = sample[i].key - sample[i - 1].key;
+        if (gap <= 2 * average) {
+            total += gap;
+            gaps++;
+        }
+    }
+    double width = gaps > 0 ? 3 * total / gaps : 1;
+    shift = 0;
+    while ((double)(1L << shift) < width && shift < 30) shift++;
+    return shift;
+}
+
+// moves every entry into num_buckets new buckets, with the width recalculated from the first entries
+static void resize(CalendarQueue *q, int num_buckets) {
+    HeapNode sample[CALQUEUE_SAMPLE];
+    int n = 0;
+    int i, j;
+    while (n < CALQUEUE_SAMPLE && q->count > 0) sample[n++] = take_first(q);
+
+    PriorityQueue *old = q->buckets;
+    int old_num = q->num_buckets;
+    q->buckets = calloc(num_buckets, sizeof(PriorityQueue));
+    if (q->buckets == NULL) {
+        fprintf(stderr, "malloc() failed for the calendar queue buckets.\n");
+        exit(-1);
+    }
+    q->num_buckets = num_buckets;
+    q->shift = width_shift(sample, n, q->shift);
+    q->allocations++;
+    for (i = 0; i < old_num; i++) {
+        for (j = 0; j < old[i].count; j++) bucket_add(q, &q->buckets[bucket_of(q, old[i].arr[j].key)], old[i].arr[j]);
+        free(old[i].arr);
+    }
+    free(old);
+    for (i = 0; i < n; i++) bucket_add(q, &q->buckets[bucket_of(q, sample[i].key)], sample[i]);
+    q->count += n;
+    if (n > 0) { // the sample starts with the first entry
+        q->current = bucket_of(q, sample[0].key);
+        q->current_end = window_end(q, sample[0].key);
+    }
+    q->searches = 0;
+}
+
+CalendarQueue *calqueue_create(void) {
+    CalendarQueue *q = malloc(sizeof(CalendarQueue));
+    if (q != NULL) q->buckets = calloc(CALQUEUE_MIN_BUCKETS, sizeof(PriorityQueue));
+    if (q == NULL || q->buckets == NULL) {
+        fprintf(stderr, "malloc() failed for the calendar queue.\n");
+        exit(-1);
+    }
+    q->num_buckets = CALQUEUE_MIN_BUCKETS;
+    q->shift = CALQUEUE_INITIAL_SHIFT;
+    q->count = 0;
+    q->current = 0;
+    q->current_end = 1L << CALQUEUE_INITIAL_SHIFT;
+    q->searches = 0;
+    q->allocations = 0;
+    return q;
+}
+
+void calqueue_free(CalendarQueue *q) {
+    int i;
+    if (q == NULL) return;
+    for (i = 0; i < q->num_buckets; i++) free(q->buckets[i].arr);
+    free(q->buckets);
+    free(q);
+}
+
+// adds the node, moving the search back if it comes before the current bucket's window
+void calqueue_insert(CalendarQueue *q, HeapNode node) {
+    if (q->count == 0 || node.key < q->current_end - (1L << q->shift)) {
+        q->current = bucket_of(q, node.key);
+        q->current_end = window_end(q, node.key);
+    }
+    bucket_add(q, &q->buckets[bucket_of(q, node.key)], node);
+    q->count++;
+    if (q->count > 2 * q->num_buckets) resize(q, 2 * q->num_buckets);
+}
+
+// first entry in heap order, or NULL if the queue is empty; valid until the queue is next changed
+const HeapNode *calqueue_first(CalendarQueue *q) {
+    if (q->count == 0) return NULL;
+    return &q->buckets[locate(q)].arr[0];
+}
+
+// removes the first entry and returns its thread table index, or -1 if the queue is empty
+int calqueue_pop(CalendarQueue *q) {
+    if (q->count == 0) return -1;
+    HeapNode node = take_first(q);
+    if (q->num_buckets > CALQUEUE_MIN_BUCKETS && q->count < q->num_buckets / 2) resize(q, q->num_buckets / 2);
+    else if (q->searches > CALQUEUE_MAX_SEARCHES) resize(q, q->num_buckets);
+    return node.index;
+}
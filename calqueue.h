@@ -0,0 +1,40 @@
+/**
+ * calqueue.h
+ * Calendar queue: an alternative to the heap for the engine's events queue (threads waiting to
+ * arrive, e.g. blocked on I/O), built with "make EVENT_QUEUE=calendar". Times are integers, so
+ * the time line is cut into buckets of a power-of-two width that wrap around a power-of-two
+ * number of buckets like the days of a year, and an entry goes in the bucket of its key. The first
+ * entry is found by walking forward from the bucket of the last one taken, so inserting and taking
+ * the first entry cost O(1) on average instead of O(log n) while the buckets hold a few entries
+ * each. The number of buckets doubles or halves with the number of entries, and the width is then
+ * recalculated from how far apart their keys are.
+ * Each bucket is itself a small heap (heap.h), so entries come out in the same order as from one
+ * big heap (key, then process, thread and table index), and many threads sharing one time unit
+ * (which no bucket width can split) cost no more than they would in a heap.
+ */
+
+#ifndef CALQUEUE_H
+#define CALQUEUE_H
+
+#include "heap.h"
+
+#define CALQUEUE_MIN_BUCKETS 64
+
+typedef struct calqueue_struct {
+    PriorityQueue *buckets; // arr is NULL until a bucket is first used
+    int num_buckets;  // a power of two
+    int shift;        // buckets are (1 << shift) time units wide
+    int count;
+    int current;      // bucket the search for the first entry starts at
+    long current_end; // end of the current bucket's time window; no entry is before its start
+    int searches;     // times a year went by without finding the first entry, since the last resize
+    long allocations; // times a bucket was allocated or had to grow, or the buckets were resized
+} CalendarQueue;
+
+CalendarQueue *calqueue_create(void);
+void calqueue_free(CalendarQueue *q);
+void calqueue_insert(CalendarQueue *q, HeapNode node);
+const HeapNode *calqueue_first(CalendarQueue *q);
+int calqueue_pop(CalendarQueue *q);
+
+#endif
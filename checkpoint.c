@@ -0,0 +1,165 @@
+/**
+ * checkpoint.c
+ * Simulation snapshots - see checkpoint.h
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include "checkpoint.h"
+
+#define FNV_OFFSET 14695981039346656037ull
+#define FNV_PRIME 1099511628211ull
+
+// reports a bad snapshot as bad input (see load_error), closing it first
+static void checkpoint_error(FILE *in, const char *name, const char *message) {
+    fclose(in);
+    load_error("%s: %s", name, message);
+}
+
+static inline uint64_t fnv_add(uint64_t hash, int32_t value) {
+    int i;
+    for (i = 0; i < 4; i++) {
+        hash ^= (uint32_t)value >> (8 * i) & 0xff;
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+// FNV-1a hash of everything in the workload a simulation depends on: the switch costs and every
+// thread's numbers, arrival time and bursts, in table order
+uint64_t workload_fingerprint(const Workload *w) {
+    uint64_t hash = FNV_OFFSET;
+    int i, j;
+    hash = fnv_add(hash, w->units_same_switch);
+    hash = fnv_add(hash, w->units_diff_switch);
+    for (i = 0; i < w->threads.count; i++) {
+        const Thread *t = &w->threads.arr[i];
+        if (t->cpu_burst_times == NULL) continue; // released slot
+        hash = fnv_add(hash, t->process_num);
+        hash = fnv_add(hash, t->thread_num);
+        hash = fnv_add(hash, t->original_arrival_time);
+        hash = fnv_add(hash, t->burst_num);
+        for (j = 0; j < t->burst_num; j++) {
+            hash = fnv_add(hash, t->cpu_burst_times[j]);
+            hash = fnv_add(hash, t->io_burst_times[j]);
+        }
+    }
+    return hash;
+}
+
+// Writes the state and the state of every thread of the (fully loaded) workload to path. Returns 0,
+// or -1 with errno set if the file cannot be written.
+int write_checkpoint(const char *path, const Workload *w, const SimState *state) {
+    CheckpointHeader h;
+    const SimCounters *c = &state->counters;
+    int i;
+    memset(&h, 0, sizeof(CheckpointHeader));
+    memcpy(h.magic, CHECKPOINT_MAGIC, CHECKPOINT_MAGIC_LEN);
+    h.version = CHECKPOINT_VERSION;
+    h.byte_order = CHECKPOINT_BYTE_ORDER;
+    h.header_size = sizeof(CheckpointHeader);
+    h.thread_size = sizeof(CheckpointThread);
+    h.fingerprint = workload_fingerprint(w);
+    h.num_threads = w->threads.count;
+    h.time_total = state->time_total;
+    h.cpu_time_total = state->cpu_time_total;
+    h.process_num = state->process_num;
+    h.thread_num = state->thread_num;
+    h.last_burst_num = state->last_burst_num;
+    h.max_queue_depth = c->max_queue_depth;
+    h.dispatches = state->dispatches;
+    h.queue_inserts = c->queue_inserts;
+    h.queue_pops = c->queue_pops;
+    h.allocations = c->allocations;
+    h.same_switches = c->same_switches;
+    h.diff_switches = c->diff_switches;
+    h.same_switch_time = c->same_switch_time;
+    h.diff_switch_time = c->diff_switch_time;
+    h.preemptions = c->preemptions;
+    h.bursts_completed = c->bursts_completed;
+    h.idle_time = c->idle_time;
+
+    FILE *out = fopen(path, "wb");
+    if (out == NULL) return -1;
+    setvbuf(out, NULL, _IOFBF, 1 << 20);
+    fwrite(&h, sizeof(h), 1, out);
+    for (i = 0; i < w->threads.count; i++) {
+        const Thread *t = &w->threads.arr[i];
+        CheckpointThread ct;
+        ct.arrival_time = t->arrival_time;
+        ct.current_burst = t->current_burst;
+        ct.remaining = t->remaining;
+        ct.queue_level = t->queue_level;
+        ct.time_enters_cpu = t->time_enters_cpu;
+        ct.time_first_enters_cpu = t->time_first_enters_cpu;
+        ct.time_finished = t->time_finished;
+        fwrite(&ct, sizeof(ct), 1, out);
+    }
+    if (ferror(out)) {
+        fclose(out);
+        return -1;
+    }
+    return fclose(out) != 0 ? -1 : 0;
+}
+
+// Reads a snapshot of the given (fully loaded) workload into state and the workload's threads.
+// A snapshot that cannot be read, or was taken of another workload, is reported with load_error.
+void read_checkpoint(const char *path, Workload *w, SimState *state) {
+    CheckpointHeader h;
+    SimCounters *c = &state->counters;
+    int i;
+    FILE *in = fopen(path, "rb");
+    if (in == NULL) load_error("%s: %s", path, strerror(errno));
+    if (fread(&h, sizeof(h), 1, in) != 1 || memcmp(h.magic, CHECKPOINT_MAGIC, CHECKPOINT_MAGIC_LEN) != 0) {
+        checkpoint_error(in, path, "not a simulation checkpoint");
+    }
+    if (h.byte_order != CHECKPOINT_BYTE_ORDER) checkpoint_error(in, path, "checkpoint was written on a machine with a different byte order");
+    if (h.version != CHECKPOINT_VERSION) checkpoint_error(in, path, "unsupported checkpoint version");
+    if (h.header_size != sizeof(CheckpointHeader) || h.thread_size != sizeof(CheckpointThread)) {
+        checkpoint_error(in, path, "unexpected checkpoint header size");
+    }
+    if (h.num_threads != w->threads.count || h.fingerprint != workload_fingerprint(w)) {
+        checkpoint_error(in, path, "checkpoint was taken of a different workload");
+    }
+
+    memset(state, 0, sizeof(SimState));
+    state->time_total = h.time_total;
+    state->cpu_time_total = h.cpu_time_total;
+    state->process_num = h.process_num;
+    state->thread_num = h.thread_num;
+    state->last_burst_num = h.last_burst_num;
+    state->dispatches = h.dispatches;
+    c->max_queue_depth = h.max_queue_depth;
+    c->queue_inserts = h.queue_inserts;
+    c->queue_pops = h.queue_pops;
+    c->allocations = h.allocations;
+    c->same_switches = h.same_switches;
+    c->diff_switches = h.diff_switches;
+    c->same_switch_time = h.same_switch_time;
+    c->diff_switch_time = h.diff_switch_time;
+    c->preemptions = h.preemptions;
+    c->bursts_completed = h.bursts_completed;
+    c->idle_time = h.idle_time;
+
+    for (i = 0; i < w->threads.count; i++) {
+        Thread *t = &w->threads.arr[i];
+        CheckpointThread ct;
+        if (fread(&ct, sizeof(ct), 1, in) != 1) checkpoint_error(in, path, "checkpoint is truncated");
+        if (ct.current_burst < 0 || ct.current_burst > t->burst_num) checkpoint_error(in, path, "thread is at a burst it does not have");
+        if (ct.remaining < 0 || (ct.current_burst < t->burst_num && ct.remaining > t->cpu_burst_times[ct.current_burst])) {
+            checkpoint_error(in, path, "thread has CPU time left outside its current burst");
+        }
+        if (ct.queue_level < 0 || ct.queue_level >= MLFQ_LEVELS) checkpoint_error(in, path, "thread is at a queue level that does not exist");
+        t->arrival_time = ct.arrival_time;
+        t->current_burst = ct.current_burst;
+        t->remaining = ct.remaining;
+        t->queue_level = ct.queue_level;
+        t->core = -1;
+        t->time_enters_cpu = ct.time_enters_cpu;
+        t->time_first_enters_cpu = ct.time_first_enters_cpu;
+        t->time_finished = ct.time_finished;
+    }
+    fclose(in);
+}
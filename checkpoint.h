@@ -0,0 +1,68 @@
+/**
+ * checkpoint.h
+ * Snapshot of a paused simulation, written by "simcpu --checkpoint" and read by "simcpu --resume"
+ * to carry on from the same point (under the same or another policy) without simulating the
+ * start again. The snapshot holds the engine's state and the state of every thread, not the
+ * workload itself: it is resumed with the same input file, which is checked against a fingerprint
+ * of the workload taken when the snapshot was written.
+ *
+ * Layout (all integers in host byte order, checked with byte_order):
+ *   CheckpointHeader
+ *   CheckpointThread threads[num_threads]   (in the order of the workload's thread table)
+ */
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <stdint.h>
+#include "engine.h"
+
+#define CHECKPOINT_MAGIC "SIMCPUCK"
+#define CHECKPOINT_MAGIC_LEN 8
+#define CHECKPOINT_VERSION 1
+#define CHECKPOINT_BYTE_ORDER 0x01020304u
+
+typedef struct checkpoint_header_struct {
+    char magic[CHECKPOINT_MAGIC_LEN];
+    uint32_t version;
+    uint32_t byte_order;
+    uint32_t header_size;
+    uint32_t thread_size;
+    uint64_t fingerprint; // of the workload (see workload_fingerprint)
+    int64_t num_threads;
+    // SimState
+    int32_t time_total;
+    int32_t cpu_time_total;
+    int32_t process_num;
+    int32_t thread_num;
+    int32_t last_burst_num;
+    int32_t max_queue_depth;
+    int64_t dispatches;
+    int64_t queue_inserts;
+    int64_t queue_pops;
+    int64_t allocations;
+    int64_t same_switches;
+    int64_t diff_switches;
+    int64_t same_switch_time;
+    int64_t diff_switch_time;
+    int64_t preemptions;
+    int64_t bursts_completed;
+    int64_t idle_time;
+} CheckpointHeader;
+
+// what a simulation changes in a thread
+typedef struct checkpoint_thread_struct {
+    int32_t arrival_time;
+    int32_t current_burst;
+    int32_t remaining;
+    int32_t queue_level;
+    int32_t time_enters_cpu;
+    int32_t time_first_enters_cpu;
+    int32_t time_finished;
+} CheckpointThread;
+
+uint64_t workload_fingerprint(const Workload *w);
+int write_checkpoint(const char *path, const Workload *w, const SimState *state);
+void read_checkpoint(const char *path, Workload *w, SimState *state);
+
+#endif
@@ -0,0 +1,706 @@
+/**
+ * engine.c
+ * The simulation engine: the steps every policy shares (context switches, running a slice of a
+ * burst, blocking and terminating threads, verbose output) and one simulation loop per policy,
+ * generated from engine_loop.h.
+ *
+ * The steps take a "count" argument that is a constant in every loop, so each is inlined into the
+ * loop without the counting code, or with it for the counting version of the loop.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include "engine.h"
+#include "heap.h"
+#include "calqueue.h"
+#include "verbose.h"
+
+#define CORE_QUEUE_CAPACITY 64 // initial capacity of each core's run queues
+
+// always inlined, so a constant "count" argument removes the counting code
+#define ENGINE_INLINE static inline __attribute__((always_inline))
+
+// the events queue is a heap, or a calendar queue when built with EVENT_QUEUE=calendar (see calqueue.h)
+#ifdef ENGINE_CALENDAR_QUEUE
+typedef CalendarQueue EventQueue;
+#define EVENT_QUEUE_NAME "calendar"
+#define event_queue_create() calqueue_create()
+#define event_queue_free(q) calqueue_free(q)
+#define event_queue_insert(q, node) calqueue_insert(q, node)
+#define event_queue_pop(q) calqueue_pop(q)
+#define event_queue_first(q) calqueue_first(q)
+#define event_queue_allocations(q) ((q)->allocations)
+#else
+typedef PriorityQueue EventQueue;
+#define EVENT_QUEUE_NAME "heap"
+#define event_queue_create() CreateHeap(HEAP_INITIAL_CAPACITY)
+#define event_queue_free(q) FreeHeap(q)
+#define event_queue_insert(q, node) insert(q, node)
+#define event_queue_pop(q) PopMin(q)
+#define event_queue_first(q) ((q)->count > 0 ? &(q)->arr[0] : NULL)
+#define event_queue_allocations(q) ((long)(q)->capacity)
+#endif
+
+typedef struct core_struct {
+    int clock;       // time the core is next free
+    int process_num; // last thread on this core, -1 before the first
+    int thread_num;
+    int ready_count; // threads in its run queues
+    bool parked;     // idle, on the idle list until a thread is queued for it
+    int idle_prev;   // neighbours on the idle list
+    int idle_next;
+    PriorityQueue *ready[MLFQ_LEVELS]; // run queue per policy level
+    CoreStats *stats;
+} Core;
+
+typedef struct engine_struct {
+    Workload *w;
+    WorkloadReader *reader; // NULL once every thread is in the table
+    const SimConfig *cfg;
+    Report *report;
+    SimResult *res;
+    int quantum;
+    EventQueue *events;    // threads keyed on arrival time (for FCFS and RR, the ready queue itself)
+    int pending;           // next thread read but not yet queued, or -1
+    VerboseBuffer verbose; // transitions waiting to be printed in time order
+    int time_total;
+    int cpu_time_total;
+    int process_num;    // last thread on the CPU
+    int thread_num;
+    int last_burst_num;
+    int pause_time;     // when to call cfg->on_pause, INT_MAX once called (or without one)
+    Core *cores;             // with more than one core
+    int num_cores;
+    PriorityQueue *core_queue; // cores with work to look for, keyed on when they are free
+    int idle_head;           // first idle core, or -1
+} Engine;
+
+typedef void (*PolicyLoop)(Engine *e);
+
+// builds a queue entry for the Thread stored at the given table index
+static inline HeapNode thread_key(const Thread *t, int index, int key) {
+    HeapNode node;
+    node.key = key;
+    node.process_num = t->process_num;
+    node.thread_num = t->thread_num;
+    node.index = index;
+    return node;
+}
+
+// inserts into one of the engine's heaps
+ENGINE_INLINE void queue_insert(Engine *e, const bool count, PriorityQueue *q, HeapNode node) {
+    if (count) {
+        SimCounters *c = &e->res->counters;
+        int capacity = q->capacity;
+        insert(q, node);
+        c->queue_inserts++;
+        if (q->capacity != capacity) c->allocations++;
+        if (q->count > c->max_queue_depth) c->max_queue_depth = q->count;
+    } else {
+        insert(q, node);
+    }
+}
+
+// pops the first entry of one of the engine's heaps, returns its index
+ENGINE_INLINE int queue_pop(Engine *e, const bool count, PriorityQueue *q) {
+    if (count) e->res->counters.queue_pops++;
+    return PopMin(q);
+}
+
+// inserts into the events queue
+ENGINE_INLINE void event_insert(Engine *e, const bool count, HeapNode node) {
+    if (count) {
+        SimCounters *c = &e->res->counters;
+        long allocations = event_queue_allocations(e->events);
+        event_queue_insert(e->events, node);
+        c->queue_inserts++;
+        if (event_queue_allocations(e->events) != allocations) c->allocations++;
+        if (e->events->count > c->max_queue_depth) c->max_queue_depth = e->events->count;
+    } else {
+        event_queue_insert(e->events, node);
+    }
+}
+
+// pops the first entry of the events queue, returns its index
+ENGINE_INLINE int event_pop(Engine *e, const bool count) {
+    if (count) e->res->counters.queue_pops++;
+    return event_queue_pop(e->events);
+}
+
+// first entry of the events queue, or NULL if it is empty
+static inline const HeapNode *first_event(Engine *e) {
+    return event_queue_first(e->events);
+}
+
+// time of the first entry of the events queue, or INT_MAX if it is empty
+static inline int next_event(Engine *e) {
+    const HeapNode *first = event_queue_first(e->events);
+    return first != NULL ? first->key : INT_MAX;
+}
+
+// true if the pending thread has to be queued before the next pop: it arrives no later than the
+// earliest queued thread (all the queue could need, since the input is sorted by arrival time) or
+// no later than the given time
+static inline bool pending_due(Engine *e, int until) {
+    if (e->pending == -1) return false;
+    int arrival = e->w->threads.arr[e->pending].arrival_time;
+    return arrival <= until || arrival <= next_event(e);
+}
+
+// Stops reading the input once the reason is in the result: the run carries on with the threads
+// already read and run_simulation returns the error.
+static void stop_reading(Engine *e) {
+    e->pending = -1;
+    e->reader = NULL;
+}
+
+// reads the thread after the pending one, stopping at bad input
+static void read_pending(Engine *e) {
+    LoadError err;
+    if (setjmp(err.jump) != 0) {
+        snprintf(e->res->error, sizeof(e->res->error), "%s", err.message);
+        stop_reading(e);
+        return;
+    }
+    catch_load_errors(&err);
+    e->pending = read_next_thread(e->reader, e->w);
+    release_load_errors(&err);
+    if (e->pending != -1) e->res->threads_read++;
+}
+
+// queues the pending thread and reads the one after it
+ENGINE_INLINE void queue_pending(Engine *e, const bool count) {
+    ThreadTable *threads = &e->w->threads;
+    event_insert(e, count, thread_key(&threads->arr[e->pending], e->pending, threads->arr[e->pending].arrival_time));
+    read_pending(e);
+    if (e->cfg->max_resident > 0 && resident_threads(threads) > e->cfg->max_resident) {
+        snprintf(e->res->error, sizeof(e->res->error), "more than %d threads held at time %d (--max-resident)",
+                e->cfg->max_resident, e->time_total);
+        stop_reading(e);
+    }
+}
+
+// verbose output for a thread reaching the ready queue for the first time
+static inline void new_to_ready(Engine *e, const Thread *t) {
+    if (e->cfg->verbose && t->time_first_enters_cpu < 0) {
+        verbose_add(&e->verbose, t->arrival_time, t->process_num, t->thread_num, NEW_NUM, READY_NUM);
+    }
+}
+
+// puts the thread on the CPU, paying for the context switch
+ENGINE_INLINE void start_thread(Engine *e, const bool count, Thread *t) {
+    SimCounters *c = &e->res->counters;
+    // not first time through
+    if (e->time_total != 0) {
+        if (e->process_num == t->process_num) { // context switch - same process
+            if (e->thread_num != t->thread_num) { // different thread number
+                e->time_total += e->w->units_same_switch;
+                if (count) {
+                    c->same_switches++;
+                    c->same_switch_time += e->w->units_same_switch;
+                }
+            } else if (e->last_burst_num != t->current_burst - 1 && t->current_burst > 0) {
+                // same thread number AND last burst isn't the same (there is no I/O before the first burst,
+                // and io_burst_times[-1] would be the thread's last CPU burst, as the two share a block)
+                e->time_total += t->io_burst_times[t->current_burst - 1];
+                if (count) c->idle_time += t->io_burst_times[t->current_burst - 1];
+            }
+        } else { // context switch - different process
+            e->time_total += e->w->units_diff_switch;
+            if (count) {
+                c->diff_switches++;
+                c->diff_switch_time += e->w->units_diff_switch;
+            }
+        }
+        // set time entering CPU for this thread
+        t->time_enters_cpu = e->time_total;
+        e->last_burst_num = t->current_burst - 1;
+    }
+    // where time total matches "Time Enters CPU"
+    if (t->time_first_enters_cpu < 0) t->time_first_enters_cpu = e->time_total;
+    e->res->dispatches++;
+
+    // Verbose Output for ready to running
+    if (e->cfg->verbose) {
+        verbose_add(&e->verbose, e->time_total, t->process_num, t->thread_num, READY_NUM, RUNNING_NUM);
+    }
+}
+
+// Runs the thread on the CPU for the given time, which is at most what is left of its burst. If the
+// burst is done the thread blocks for its I/O or terminates, otherwise it is preempted straight back
+// to ready. Either way it is queued again at the time it will next be ready.
+ENGINE_INLINE void run_slice(Engine *e, const bool count, int index, int run) {
+    Thread *t = &e->w->threads.arr[index];
+    bool preempted = run < t->remaining;
+    if (count && preempted) e->res->counters.preemptions++;
+    else if (count) e->res->counters.bursts_completed++;
+    e->cpu_time_total += run;
+    e->time_total += run;
+    if (preempted) {
+        t->remaining -= run;
+        t->arrival_time = run + t->time_enters_cpu;
+    } else {
+        t->arrival_time = run + t->io_burst_times[t->current_burst] + t->time_enters_cpu;
+        t->current_burst++;
+        if (t->current_burst < t->burst_num) t->remaining = t->cpu_burst_times[t->current_burst];
+    }
+    e->process_num = t->process_num;
+    e->thread_num = t->thread_num;
+
+    // move thread back into queue unless it has finished
+    if (t->current_burst < t->burst_num) {
+        event_insert(e, count, thread_key(t, index, t->arrival_time));
+
+        if (e->cfg->verbose && preempted) { // slice expired, straight back to ready
+            verbose_add(&e->verbose, t->arrival_time, t->process_num, t->thread_num, RUNNING_NUM, READY_NUM);
+        } else if (e->cfg->verbose) {
+            // Verbose Output from running to blocked, then blocked to ready
+            verbose_add(&e->verbose, e->time_total, t->process_num, t->thread_num, RUNNING_NUM, BLOCKED_NUM);
+            verbose_add(&e->verbose, t->arrival_time, t->process_num, t->thread_num, BLOCKED_NUM, READY_NUM);
+        }
+    } else { // last burst finished
+        // record the thread's summary; the Thread itself is not needed anymore
+        t->time_finished = e->time_total;
+        report_thread_finished(e->report, t);
+        if (e->cfg->verbose) {
+            verbose_add(&e->verbose, e->time_total, t->process_num, t->thread_num, RUNNING_NUM, TERMINATED_NUM);
+        }
+        release_thread(e->w, index);
+    }
+}
+
+// Most consecutive slices, up to max, after which a thread put back in the queue with the key
+// start + n * quantum would still be the next one popped: before the first queued entry (ties go by
+// process, thread and table index, as in the heap), and before the next thread to be read, which
+// may be followed by others arriving at the same time.
+static inline int slices_ahead(Engine *e, const Thread *t, int index, int start, int max) {
+    int n = max;
+    const HeapNode *next = first_event(e);
+    if (next != NULL) {
+        HeapNode tie = thread_key(t, index, next->key);
+        long room = (long)next->key - start - (node_less(&tie, next) ? 0 : 1);
+        if (room < 0) return 0;
+        if (room / e->quantum < n) n = (int)(room / e->quantum);
+    }
+    if (e->pending != -1) {
+        long room = (long)e->w->threads.arr[e->pending].arrival_time - start - 1;
+        if (room < 0) return 0;
+        if (room / e->quantum < n) n = (int)(room / e->quantum);
+    }
+    return n;
+}
+
+// RR fast-forward: the thread just put on the CPU runs a quantum, goes back in the queue and, if it is
+// still first there, runs again straight away with no context switch. Rather than going through the
+// queue for each of those quanta, this runs all of them at once (with the same verbose output, one
+// preemption each), leaving the thread at the start of the one slice that the simulation loop
+// still has to run: its last, or one after which another thread's turn comes.
+ENGINE_INLINE void fast_forward(Engine *e, const bool count, Thread *t, int index) {
+    int quantum = e->quantum;
+    int n = slices_ahead(e, t, index, t->time_enters_cpu, (t->remaining - 1) / quantum);
+    if (n <= 0) return;
+    if (e->cfg->verbose) {
+        int j;
+        for (j = 1; j <= n; j++) {
+            int time = t->time_enters_cpu + j * quantum;
+            verbose_add(&e->verbose, time, t->process_num, t->thread_num, RUNNING_NUM, READY_NUM);
+            verbose_add(&e->verbose, time, t->process_num, t->thread_num, READY_NUM, RUNNING_NUM);
+        }
+    }
+    int ran = n * quantum;
+    t->remaining -= ran;
+    t->time_enters_cpu += ran;
+    e->time_total = t->time_enters_cpu;
+    e->cpu_time_total += ran;
+    e->last_burst_num = t->current_burst - 1;
+    e->res->dispatches += n;
+    if (count) e->res->counters.preemptions += n;
+}
+
+// hands where the simulation stands to cfg->on_pause, once
+static void pause_simulation(Engine *e) {
+    SimState state;
+    state.time_total = e->time_total;
+    state.cpu_time_total = e->cpu_time_total;
+    state.process_num = e->process_num;
+    state.thread_num = e->thread_num;
+    state.last_burst_num = e->last_burst_num;
+    state.dispatches = e->res->dispatches;
+    state.counters = e->res->counters;
+    e->pause_time = INT_MAX;
+    e->cfg->on_pause(e->w, &state, e->cfg->pause_arg);
+}
+
+// print the transitions that nothing still to come can precede: every later transition happens at or
+// after the current time, or at the arrival of a thread still queued or still to be read
+static inline void flush_verbose(Engine *e) {
+    int watermark = e->time_total;
+    if (next_event(e) < watermark) watermark = next_event(e);
+    if (e->pending != -1 && e->w->threads.arr[e->pending].arrival_time < watermark) {
+        watermark = e->w->threads.arr[e->pending].arrival_time;
+    }
+    verbose_flush(&e->verbose, watermark, e->cfg->out);
+}
+
+/* ------------------------------------ MULTIPLE CORES ------------------------------------ */
+
+// core whose run queues hold the fewest threads (lowest numbered on ties)
+static int least_loaded_core(const Engine *e) {
+    int k, best = 0;
+    for (k = 1; k < e->num_cores; k++) {
+        if (e->cores[k].ready_count < e->cores[best].ready_count) best = k;
+    }
+    return best;
+}
+
+// core whose run queues hold the most threads, or -1 if every run queue is empty
+static int busiest_core(const Engine *e) {
+    int k, best = -1;
+    for (k = 0; k < e->num_cores; k++) {
+        if (e->cores[k].ready_count > 0 && (best == -1 || e->cores[k].ready_count > e->cores[best].ready_count)) best = k;
+    }
+    return best;
+}
+
+// queues a core to look for work at its clock
+ENGINE_INLINE void schedule_core(Engine *e, const bool count, int k) {
+    HeapNode node;
+    node.key = e->cores[k].clock;
+    node.process_num = 0;
+    node.thread_num = 0;
+    node.index = k;
+    queue_insert(e, count, e->core_queue, node);
+}
+
+// puts core k on the front of the idle list, where it waits for a thread to be queued
+static inline void park_core(Engine *e, int k) {
+    Core *core = &e->cores[k];
+    core->parked = true;
+    core->idle_prev = -1;
+    core->idle_next = e->idle_head;
+    if (e->idle_head != -1) e->cores[e->idle_head].idle_prev = k;
+    e->idle_head = k;
+}
+
+// takes core k off the idle list and queues it to look for work at the given time
+ENGINE_INLINE void wake_core(Engine *e, const bool count, int k, int now) {
+    Core *core = &e->cores[k];
+    if (core->idle_prev != -1) e->cores[core->idle_prev].idle_next = core->idle_next;
+    else e->idle_head = core->idle_next;
+    if (core->idle_next != -1) e->cores[core->idle_next].idle_prev = core->idle_prev;
+    core->parked = false;
+    if (core->clock < now) {
+        if (count) e->res->counters.idle_time += now - core->clock;
+        core->clock = now;
+    }
+    schedule_core(e, count, k);
+}
+
+// Puts a thread that has just arrived in a run queue: the one of the core it last ran on, or for a
+// new thread an idle core's (the shortest if none is idle). If that core is idle it wakes up to run
+// the thread; if it is busy past now, an idle core (if any) wakes up to steal it.
+ENGINE_INLINE void admit_to_core(Engine *e, const bool count, int index, int level, int key, int now) {
+    Thread *t = &e->w->threads.arr[index];
+    int k = t->core;
+    if (k == -1) k = e->idle_head != -1 ? e->idle_head : least_loaded_core(e);
+    new_to_ready(e, t);
+    queue_insert(e, count, e->cores[k].ready[level], thread_key(t, index, key));
+    e->cores[k].ready_count++;
+    if (e->cores[k].parked) wake_core(e, count, k, now);
+    else if (e->idle_head != -1 && e->cores[k].clock > now) wake_core(e, count, e->idle_head, now);
+}
+
+// puts the thread on core k at the core's clock, paying for the context switch and any migration,
+// and sets the engine's time to when the thread starts running
+ENGINE_INLINE void start_on_core(Engine *e, const bool count, int k, Thread *t) {
+    Core *core = &e->cores[k];
+    SimCounters *c = &e->res->counters;
+    int start = core->clock;
+    if (core->process_num != -1) {
+        if (core->process_num != t->process_num) {
+            start += e->w->units_diff_switch;
+            if (count) {
+                c->diff_switches++;
+                c->diff_switch_time += e->w->units_diff_switch;
+            }
+        } else if (core->thread_num != t->thread_num) {
+            start += e->w->units_same_switch;
+            if (count) {
+                c->same_switches++;
+                c->same_switch_time += e->w->units_same_switch;
+            }
+        }
+    }
+    if (t->core != -1 && t->core != k) {
+        start += e->cfg->migration_cost;
+        core->stats->migrations++;
+    }
+    t->core = k;
+    t->time_enters_cpu = start;
+    if (t->time_first_enters_cpu < 0) t->time_first_enters_cpu = start;
+    core->process_num = t->process_num;
+    core->thread_num = t->thread_num;
+    core->stats->dispatches++;
+    e->res->dispatches++;
+    e->time_total = start;
+
+    if (e->cfg->verbose) {
+        verbose_add(&e->verbose, start, t->process_num, t->thread_num, READY_NUM, RUNNING_NUM);
+    }
+}
+
+// after core k ran a thread for the given time, the core is free again when it finishes
+ENGINE_INLINE void finish_on_core(Engine *e, const bool count, int k, int run) {
+    Core *core = &e->cores[k];
+    core->clock = e->time_total;
+    core->stats->busy += run;
+    if (core->clock > e->res->time_total) e->res->time_total = core->clock;
+    schedule_core(e, count, k);
+}
+
+// as flush_verbose, but the earliest thing still to come may also be a core becoming free
+static inline void flush_verbose_cores(Engine *e) {
+    int watermark = e->core_queue->count > 0 ? e->core_queue->arr[0].key : e->time_total;
+    if (next_event(e) < watermark) watermark = next_event(e);
+    if (e->pending != -1 && e->w->threads.arr[e->pending].arrival_time < watermark) {
+        watermark = e->w->threads.arr[e->pending].arrival_time;
+    }
+    verbose_flush(&e->verbose, watermark, e->cfg->out);
+}
+
+/* ------------------------------ POLICIES (see engine_loop.h) ------------------------------ */
+
+// name##suffix, after expanding name
+#define ENGINE_PASTE(name, suffix) name##suffix
+#define ENGINE_NAME(name, suffix) ENGINE_PASTE(name, suffix)
+
+// FCFS: run each burst to completion in order of arrival
+#define ENGINE_LOOP_NAME run_fcfs
+#define ENGINE_CORES_LOOP_NAME run_fcfs_cores
+#define ENGINE_SINGLE_QUEUE 1
+#define ENGINE_SLICE(t, quantum) ((t)->remaining)
+#include "engine_loop.h"
+
+// RR: run at most a quantum, then back to the end of the queue
+#define ENGINE_LOOP_NAME run_rr
+#define ENGINE_CORES_LOOP_NAME run_rr_cores
+#define ENGINE_SINGLE_QUEUE 1
+#define ENGINE_SLICE(t, quantum) (quantum)
+#define ENGINE_FAST_FORWARD 1
+#include "engine_loop.h"
+
+// SJF: of the arrived threads, run the one with the shortest next CPU burst to completion
+#define ENGINE_LOOP_NAME run_sjf
+#define ENGINE_CORES_LOOP_NAME run_sjf_cores
+#define ENGINE_READY_KEY(t) ((t)->remaining)
+#include "engine_loop.h"
+
+// SRTF: as SJF, but a thread arriving with less left to run than the running one takes the CPU
+// (single core only)
+#define ENGINE_LOOP_NAME run_srtf
+#define ENGINE_READY_KEY(t) ((t)->remaining)
+#define ENGINE_PREEMPT_ON_ARRIVAL 1
+#include "engine_loop.h"
+
+// static priority: of the arrived threads, run one of the lowest numbered process
+#define ENGINE_LOOP_NAME run_priority
+#define ENGINE_CORES_LOOP_NAME run_priority_cores
+#define ENGINE_READY_KEY(t) ((t)->process_num)
+#include "engine_loop.h"
+
+// MLFQ: run the earliest arrived thread of the highest level with any; a thread that uses up its
+// level's quantum (which doubles per level) is moved down a level
+#define ENGINE_LOOP_NAME run_mlfq
+#define ENGINE_CORES_LOOP_NAME run_mlfq_cores
+#define ENGINE_LEVELS MLFQ_LEVELS
+#define ENGINE_READY_LEVEL(t) ((t)->queue_level)
+#define ENGINE_SLICE(t, quantum) ((quantum) << (t)->queue_level)
+#define ENGINE_ON_PREEMPT(t) if ((t)->queue_level < MLFQ_LEVELS - 1) (t)->queue_level++
+#include "engine_loop.h"
+
+// each loop without and with counters (indexed by SimConfig.count)
+static const struct {
+    const char *name;
+    PolicyLoop run[2];
+    PolicyLoop run_cores[2]; // NULL if the policy only runs on one core
+} policies[NUM_POLICIES] = {
+    [POLICY_FCFS] = {"fcfs", {run_fcfs, run_fcfs_counted}, {run_fcfs_cores, run_fcfs_cores_counted}},
+    [POLICY_RR] = {"rr", {run_rr, run_rr_counted}, {run_rr_cores, run_rr_cores_counted}},
+    [POLICY_SJF] = {"sjf", {run_sjf, run_sjf_counted}, {run_sjf_cores, run_sjf_cores_counted}},
+    [POLICY_SRTF] = {"srtf", {run_srtf, run_srtf_counted}, {NULL, NULL}},
+    [POLICY_PRIORITY] = {"priority", {run_priority, run_priority_counted}, {run_priority_cores, run_priority_cores_counted}},
+    [POLICY_MLFQ] = {"mlfq", {run_mlfq, run_mlfq_counted}, {run_mlfq_cores, run_mlfq_cores_counted}},
+};
+
+// sets up the cores, all idle at time 0 with empty run queues; returns -1 if they cannot be allocated
+static int start_cores(Engine *e, int num_cores) {
+    int k, level;
+    e->cores = calloc(num_cores, sizeof(Core));
+    e->res->core_stats = calloc(num_cores, sizeof(CoreStats));
+    if (e->cores == NULL || e->res->core_stats == NULL) {
+        free(e->cores);
+        free_sim_result(e->res);
+        snprintf(e->res->error, sizeof(e->res->error), "malloc() failed for %d cores", num_cores);
+        return -1;
+    }
+    e->num_cores = num_cores;
+    e->res->num_cores = num_cores;
+    e->core_queue = CreateHeap(num_cores);
+    e->idle_head = -1;
+    for (k = num_cores - 1; k >= 0; k--) { // every core starts idle, core 0 first in line
+        e->cores[k].process_num = -1;
+        e->cores[k].stats = &e->res->core_stats[k];
+        for (level = 0; level < MLFQ_LEVELS; level++) e->cores[k].ready[level] = CreateHeap(CORE_QUEUE_CAPACITY);
+        park_core(e, k);
+    }
+    return 0;
+}
+
+// frees the cores
+static void stop_cores(Engine *e) {
+    int k, level;
+    for (k = 0; k < e->num_cores; k++) {
+        for (level = 0; level < MLFQ_LEVELS; level++) FreeHeap(e->cores[k].ready[level]);
+    }
+    free(e->cores);
+    FreeHeap(e->core_queue);
+}
+
+/* ------------------------------------ PUBLIC FUNCTIONS ------------------------------------ */
+
+// looks up a policy by its command line name, returns 0 if there is no such policy
+int parse_policy(const char *name, PolicyKind *policy) {
+    int i;
+    for (i = 0; i < NUM_POLICIES; i++) {
+        if (strcmp(name, policies[i].name) == 0) {
+            *policy = i;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+const char *policy_name(PolicyKind policy) {
+    return policies[policy].name;
+}
+
+// true if the policy's time slices depend on the quantum
+bool policy_uses_quantum(PolicyKind policy) {
+    return policy == POLICY_RR || policy == POLICY_MLFQ;
+}
+
+// true if the policy can be simulated on more than one core
+bool policy_supports_cores(PolicyKind policy) {
+    return policies[policy].run_cores[0] != NULL;
+}
+
+// which events queue the engine was built with
+const char *event_queue_name(void) {
+    return EVENT_QUEUE_NAME;
+}
+
+// quantum the policy actually runs with
+static int effective_quantum(const SimConfig *cfg) {
+    if (cfg->quantum > 0) return cfg->quantum;
+    return cfg->policy == POLICY_MLFQ ? MLFQ_DEFAULT_QUANTUM : 1;
+}
+
+// prints the first line of the output, naming the policy
+void print_policy_header(const SimConfig *cfg, FILE *out) {
+    switch (cfg->policy) {
+        case POLICY_FCFS: fprintf(out, "FCFS Scheduling\n"); break;
+        case POLICY_RR: fprintf(out, "Round Robin Scheduling (quantum = %d time units)\n", cfg->quantum); break;
+        case POLICY_SJF: fprintf(out, "Shortest Job First Scheduling\n"); break;
+        case POLICY_SRTF: fprintf(out, "Shortest Remaining Time First Scheduling\n"); break;
+        case POLICY_PRIORITY: fprintf(out, "Static Priority Scheduling (by process number)\n"); break;
+        case POLICY_MLFQ:
+            fprintf(out, "Multilevel Feedback Queue Scheduling (%d levels, base quantum = %d time units)\n",
+                    MLFQ_LEVELS, effective_quantum(cfg));
+            break;
+        default: break;
+    }
+    if (cfg->cores > 1) {
+        fprintf(out, "%d Cores (migration cost = %d time units)\n", cfg->cores, cfg->migration_cost);
+    }
+}
+
+// Simulates the workload under the configured policy. Threads already in the workload's table are
+// queued first; if reader is not NULL, the rest are read from it as the simulation reaches them.
+// Finished threads are recorded in the report, and with cfg->count the loop's counters in res.
+// With cfg->resume the simulation starts from that state rather than time 0: threads that had
+// finished are only recorded in the report, and the others are queued at their arrival time.
+// Returns 0, or -1 with the reason in res->error: at once if the configuration cannot be run, or
+// after the threads already read if the input turns out to be bad or cfg->max_resident is exceeded.
+int run_simulation(Workload *w, WorkloadReader *reader, const SimConfig *cfg, Report *report, SimResult *res) {
+    Engine e;
+    int i;
+    memset(&e, 0, sizeof(Engine));
+    memset(res, 0, sizeof(SimResult));
+    if ((cfg->on_pause != NULL || cfg->resume != NULL) && cfg->cores > 1) {
+        snprintf(res->error, sizeof(res->error), "a simulation can only be paused or resumed on one core");
+        return -1;
+    }
+    if (cfg->cores > 1 && policy_supports_cores(cfg->policy) == false) {
+        snprintf(res->error, sizeof(res->error), "the %s policy can only be simulated on one core", policy_name(cfg->policy));
+        return -1;
+    }
+    e.w = w;
+    e.reader = reader;
+    e.cfg = cfg;
+    e.report = report;
+    e.res = res;
+    e.quantum = effective_quantum(cfg);
+    e.pause_time = cfg->on_pause != NULL ? cfg->pause_time : INT_MAX;
+    if (cfg->resume != NULL) {
+        e.time_total = cfg->resume->time_total;
+        e.cpu_time_total = cfg->resume->cpu_time_total;
+        e.process_num = cfg->resume->process_num;
+        e.thread_num = cfg->resume->thread_num;
+        e.last_burst_num = cfg->resume->last_burst_num;
+        res->dispatches = cfg->resume->dispatches;
+        res->counters = cfg->resume->counters;
+    }
+    e.events = event_queue_create();
+    verbose_init(&e.verbose);
+
+    for (i = 0; i < w->threads.count; i++) {
+        Thread *t = &w->threads.arr[i];
+        if (t->cpu_burst_times == NULL) continue; // released slot
+        res->threads_read++;
+        if (cfg->resume != NULL && t->current_burst >= t->burst_num) { // finished before the pause
+            report_thread_finished(report, t);
+            continue;
+        }
+        event_insert(&e, cfg->count, thread_key(t, i, t->arrival_time));
+    }
+    e.pending = -1;
+    if (reader != NULL) read_pending(&e);
+
+    if (cfg->cores > 1) {
+        if (start_cores(&e, cfg->cores) == 0) {
+            policies[cfg->policy].run_cores[cfg->count](&e);
+            stop_cores(&e);
+        }
+    } else {
+        policies[cfg->policy].run[cfg->count](&e);
+        if (e.time_total >= e.pause_time) pause_simulation(&e); // paused at the very end
+        res->time_total = e.time_total;
+    }
+
+    if (cfg->verbose) {
+        verbose_flush_all(&e.verbose, cfg->out);
+        output_flush(cfg->out);
+    }
+    res->cpu_time_total = e.cpu_time_total;
+    verbose_free(&e.verbose);
+    event_queue_free(e.events);
+    return res->error[0] != '\0' ? -1 : 0;
+}
+
+// frees what run_simulation allocated in the result
+void free_sim_result(SimResult *res) {
+    free(res->core_stats);
+    res->core_stats = NULL;
+}
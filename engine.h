@@ -0,0 +1,132 @@
+/**
+ * engine.h
+ * The simulation engine. A scheduling policy decides how the ready queue is ordered, how long a
+ * thread may run before it is preempted, and what happens to it afterwards. Each policy's
+ * simulation loop is generated at compile time from engine_loop.h, so the loop that runs has no
+ * per-iteration checks of which policy is in use.
+ *
+ * FCFS and RR order ready threads by arrival time, so they use a single queue of threads keyed on
+ * arrival time (exactly the original simulator). The other policies keep threads that have not
+ * arrived yet (new, or blocked on I/O) in that queue, and move them into a ready queue ordered by
+ * the policy once the clock reaches their arrival time. As in the original simulator the clock
+ * never jumps ahead: if nothing is ready, the earliest arriving thread is run.
+ * On one core, RR runs the quanta a thread gets in a row (because nothing else is ready before it
+ * is back at the front of the queue) in one step, so a long burst with a small quantum costs one
+ * queue operation per real scheduling decision rather than one per quantum.
+ *
+ * The queue of threads that have not arrived yet is a heap, or with "make EVENT_QUEUE=calendar" a
+ * calendar queue (see calqueue.h), which takes O(1) rather than O(log n) per thread blocking on
+ * I/O. Either gives exactly the same order, ties included.
+ *
+ * On one core, a simulation can be paused at a given time to save where it stands (a SimState and
+ * each thread's own state, see checkpoint.h), and a later simulation of the same workload can carry
+ * on from there, under the same or another policy. Nothing needs to be saved about the queues: at
+ * a scheduling decision every unfinished thread is waiting for its arrival time, and those that
+ * have already arrived go straight back into the ready queue.
+ *
+ * With more than one core, each core has its own run queue (per policy level). A thread that
+ * arrives for the first time joins the shortest run queue, and one that comes back from I/O or
+ * preemption rejoins the queue of the core it last ran on. The core that is free soonest
+ * dispatches next; if its own queue is empty it steals the next thread of the longest queue, and
+ * if nothing has arrived anywhere it sits idle until the next arrival. Moving a thread to another
+ * core costs the migration time on top of the usual context switch.
+ *
+ * Every loop is generated twice, with and without the counters of SimCounters, and the counting
+ * one is only run when SimConfig.count is set, so a run without counters pays nothing for them.
+ */
+
+#ifndef ENGINE_H
+#define ENGINE_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include "loader.h"
+#include "report.h"
+#include "output.h"
+
+#define MLFQ_LEVELS 3 // queue levels of the multilevel feedback queue
+#define MLFQ_DEFAULT_QUANTUM 10
+
+typedef enum policy_kind {
+    POLICY_FCFS,     // first come first served
+    POLICY_RR,       // round robin with the given quantum
+    POLICY_SJF,      // shortest (next CPU burst) job first, not preemptive
+    POLICY_SRTF,     // shortest remaining time first, preempts when a shorter burst arrives
+    POLICY_PRIORITY, // static priority: lower process number first, not preemptive
+    POLICY_MLFQ,     // multilevel feedback queue: quantum doubles per level, demoted when it is used up
+    NUM_POLICIES
+} PolicyKind;
+
+typedef struct core_stats_struct {
+    long busy;        // time spent running threads
+    long dispatches;  // threads put on this core
+    long migrations;  // threads put on this core that last ran on another one
+    long steals;      // threads taken from another core's run queue
+} CoreStats;
+
+// what the simulation loop did, only counted when SimConfig.count is set
+typedef struct sim_counters_struct {
+    long queue_inserts;    // into any of the engine's heaps
+    long queue_pops;
+    int max_queue_depth;   // most entries in one heap at once
+    long allocations;      // heaps that had to grow during the simulation
+    long same_switches;    // context switches to another thread of the same process
+    long diff_switches;    // context switches to a thread of another process
+    long same_switch_time; // time charged for them
+    long diff_switch_time;
+    long preemptions;      // slices that ended before the burst did
+    long bursts_completed;
+    long idle_time;        // time a CPU waited for I/O to finish (or a core waited for work)
+} SimCounters;
+
+// where a simulation stands between two scheduling decisions; with the threads' own state, enough
+// to carry on from there
+typedef struct sim_state_struct {
+    int time_total;
+    int cpu_time_total;
+    int process_num;    // last thread on the CPU
+    int thread_num;
+    int last_burst_num;
+    long dispatches;
+    SimCounters counters;
+} SimState;
+
+typedef struct sim_config_struct {
+    PolicyKind policy;
+    int quantum;       // RR quantum, or the MLFQ quantum of the top level
+    int cores;         // simulated CPUs (at least 1)
+    int migration_cost; // extra switch time when a thread moves to another core
+    bool verbose;      // print state transitions to out
+    bool detailed;     // keep a summary of every thread for the detailed report
+    int max_resident;  // when streaming, fail if more threads than this are held at once (0 = no limit)
+    bool count;        // fill in the result's counters
+    OutputWriter *out; // where verbose transitions go (only used when verbose)
+    // one core only: if not NULL, called once at the first scheduling decision at or after
+    // pause_time, after which the simulation carries on
+    void (*on_pause)(const Workload *w, const SimState *state, void *arg);
+    int pause_time;
+    void *pause_arg;
+    const SimState *resume; // one core only: carry on from this state and the threads' state in the workload
+} SimConfig;
+
+typedef struct sim_result_struct {
+    int time_total;
+    int cpu_time_total;
+    long dispatches;  // times a thread was put on the CPU
+    int threads_read; // threads read from the input
+    int num_cores;
+    CoreStats *core_stats; // one per core, only with more than one core (freed by free_sim_result)
+    SimCounters counters;  // all zero unless counted
+    char error[256];       // why run_simulation returned -1 (as long as a LoadError message)
+} SimResult;
+
+int parse_policy(const char *name, PolicyKind *policy);
+const char *policy_name(PolicyKind policy);
+void print_policy_header(const SimConfig *cfg, FILE *out);
+bool policy_supports_cores(PolicyKind policy);
+bool policy_uses_quantum(PolicyKind policy);
+const char *event_queue_name(void);
+int run_simulation(Workload *w, WorkloadReader *reader, const SimConfig *cfg, Report *report, SimResult *res);
+void free_sim_result(SimResult *res);
+
+#endif
@@ -0,0 +1,210 @@
+/**
+ * engine_loop.h
+ * Template for a policy's simulation loop, included by engine.c once per policy (so there is no
+ * include guard). The including file defines:
+ * - ENGINE_LOOP_NAME: name of the generated function (and of its counting version, with "_counted"
+ *   appended; see SimCounters in engine.h)
+ * - ENGINE_SINGLE_QUEUE: 1 if ready threads are simply run in order of arrival time (FCFS, RR)
+ * - ENGINE_SLICE(t, quantum): most the thread may run before it is preempted (default: its whole burst)
+ * - ENGINE_READY_KEY(t): ready queue order of an arrived thread, lowest first (default: arrival time)
+ * - ENGINE_LEVELS, ENGINE_READY_LEVEL(t): number of ready queues and the one the thread goes in,
+ *   lower levels run first (default: one queue)
+ * - ENGINE_PREEMPT_ON_ARRIVAL: 1 if a thread arriving with a lower ready key than what the running
+ *   thread has left takes the CPU (SRTF)
+ * - ENGINE_ON_PREEMPT(t): statement run when the thread uses up its slice (e.g. MLFQ demotion)
+ * - ENGINE_FAST_FORWARD: 1 to run the quanta a thread gets in a row without the queue (RR, single
+ *   queue and one core only; see fast_forward in engine.c)
+ * - ENGINE_CORES_LOOP_NAME: if defined, name of a second function that simulates several cores
+ *   (again with a counting version)
+ * Every macro is undefined again at the end.
+ */
+
+#ifndef ENGINE_SINGLE_QUEUE
+#define ENGINE_SINGLE_QUEUE 0
+#endif
+#ifndef ENGINE_SLICE
+#define ENGINE_SLICE(t, quantum) ((t)->remaining)
+#endif
+#ifndef ENGINE_READY_KEY
+#define ENGINE_READY_KEY(t) ((t)->arrival_time)
+#endif
+#ifndef ENGINE_LEVELS
+#define ENGINE_LEVELS 1
+#endif
+#ifndef ENGINE_READY_LEVEL
+#define ENGINE_READY_LEVEL(t) 0
+#endif
+#ifndef ENGINE_PREEMPT_ON_ARRIVAL
+#define ENGINE_PREEMPT_ON_ARRIVAL 0
+#endif
+#ifndef ENGINE_ON_PREEMPT
+#define ENGINE_ON_PREEMPT(t)
+#endif
+#ifndef ENGINE_FAST_FORWARD
+#define ENGINE_FAST_FORWARD 0
+#endif
+
+// the loop is written once with count as a parameter, and generated with it constant either way
+#define ENGINE_VARIANTS(name) \
+    static void name(Engine *e) { ENGINE_NAME(name, _loop)(e, false); } \
+    static void ENGINE_NAME(name, _counted)(Engine *e) { ENGINE_NAME(name, _loop)(e, true); }
+
+#if ENGINE_SINGLE_QUEUE
+
+// every queued thread is keyed on the time it is next ready, so the queue is the ready queue
+ENGINE_INLINE void ENGINE_NAME(ENGINE_LOOP_NAME, _loop)(Engine *e, const bool count) {
+    ThreadTable *threads = &e->w->threads;
+    // loop while there are still threads in the ready queue (or still to be read)
+    while (e->events->count > 0 || e->pending != -1) {
+        if (e->time_total >= e->pause_time) pause_simulation(e);
+        while (pending_due(e, -1)) queue_pending(e, count);
+        int index = event_pop(e, count);
+        Thread *t = &threads->arr[index];
+        new_to_ready(e, t);
+        start_thread(e, count, t);
+#if ENGINE_FAST_FORWARD
+        fast_forward(e, count, t, index);
+#endif
+        int run = ENGINE_SLICE(t, e->quantum);
+        if (run >= t->remaining) run = t->remaining;
+        else { ENGINE_ON_PREEMPT(t); }
+        run_slice(e, count, index, run);
+        if (e->cfg->verbose) flush_verbose(e);
+    }
+}
+
+#else
+
+// moves a thread that has arrived from the events queue into its ready queue
+#define ENGINE_ADMIT(index) do { \
+        Thread *admitted = &threads->arr[index]; \
+        new_to_ready(e, admitted); \
+        queue_insert(e, count, ready[ENGINE_READY_LEVEL(admitted)], thread_key(admitted, index, ENGINE_READY_KEY(admitted))); \
+        ready_count++; \
+    } while (0)
+
+// threads that have not arrived yet (new, blocked or preempted) wait in the events queue, keyed on
+// arrival time, and move to a ready queue once the clock reaches them
+ENGINE_INLINE void ENGINE_NAME(ENGINE_LOOP_NAME, _loop)(Engine *e, const bool count) {
+    ThreadTable *threads = &e->w->threads;
+    PriorityQueue *ready[ENGINE_LEVELS];
+    int ready_count = 0;
+    int level;
+    for (level = 0; level < ENGINE_LEVELS; level++) ready[level] = CreateHeap(HEAP_INITIAL_CAPACITY);
+
+    while (e->events->count > 0 || e->pending != -1 || ready_count > 0) {
+        if (e->time_total >= e->pause_time) pause_simulation(e);
+        while (pending_due(e, e->time_total)) queue_pending(e, count);
+        while (next_event(e) <= e->time_total) {
+            int arrived = event_pop(e, count);
+            ENGINE_ADMIT(arrived);
+        }
+
+        int index = -1;
+        for (level = 0; index == -1 && level < ENGINE_LEVELS; level++) {
+            if (ready[level]->count > 0) {
+                index = queue_pop(e, count, ready[level]);
+                ready_count--;
+            }
+        }
+        if (index == -1) { // nothing ready: the clock does not jump, the next arrival runs now
+            index = event_pop(e, count);
+            new_to_ready(e, &threads->arr[index]);
+        }
+        start_thread(e, count, &threads->arr[index]);
+
+        Thread *t = &threads->arr[index];
+        int run = ENGINE_SLICE(t, e->quantum);
+        if (run > t->remaining) run = t->remaining;
+#if ENGINE_PREEMPT_ON_ARRIVAL
+        // threads arriving before the slice ends are admitted now; the first with less to run than
+        // the running thread has left at that moment preempts it
+        int start = t->time_enters_cpu;
+        int end = start + run;
+        for (;;) {
+            while (pending_due(e, end - 1)) queue_pending(e, count);
+            int arrival = next_event(e);
+            if (arrival >= end) break;
+            int arrived = event_pop(e, count);
+            ENGINE_ADMIT(arrived);
+            if (arrival > start && ENGINE_READY_KEY(&threads->arr[arrived]) < end - arrival) {
+                run = arrival - start;
+                break;
+            }
+        }
+        t = &threads->arr[index]; // reading threads may have moved the table
+#endif
+        if (run < t->remaining) { ENGINE_ON_PREEMPT(t); }
+        run_slice(e, count, index, run);
+        if (e->cfg->verbose) flush_verbose(e);
+    }
+
+    for (level = 0; level < ENGINE_LEVELS; level++) FreeHeap(ready[level]);
+}
+
+#undef ENGINE_ADMIT
+
+#endif
+
+ENGINE_VARIANTS(ENGINE_LOOP_NAME)
+
+#ifdef ENGINE_CORES_LOOP_NAME
+
+// Several cores, each with its own run queues ordered like the single core's ready queue. Arrivals
+// and cores becoming free are handled in time order (arrivals first on ties), so a core only ever
+// chooses among threads that have arrived by its clock.
+ENGINE_INLINE void ENGINE_NAME(ENGINE_CORES_LOOP_NAME, _loop)(Engine *e, const bool count) {
+    ThreadTable *threads = &e->w->threads;
+    int level;
+    while (e->core_queue->count > 0 || e->events->count > 0 || e->pending != -1) {
+        int next_free = e->core_queue->count > 0 ? e->core_queue->arr[0].key : -1;
+        while (pending_due(e, next_free)) queue_pending(e, count);
+        int now = next_event(e);
+        if (now != INT_MAX && (next_free == -1 || now <= next_free)) {
+            int arrived = event_pop(e, count);
+            Thread *a = &threads->arr[arrived];
+            admit_to_core(e, count, arrived, ENGINE_READY_LEVEL(a), ENGINE_READY_KEY(a), now);
+            continue;
+        }
+
+        // a core is free: run from its own run queue, or steal from the longest one, or go idle
+        int k = queue_pop(e, count, e->core_queue);
+        Core *core = &e->cores[k];
+        int source = core->ready_count > 0 ? k : busiest_core(e);
+        if (source == -1) {
+            park_core(e, k);
+            continue;
+        }
+        if (source != k) core->stats->steals++;
+        int index = -1;
+        for (level = 0; index == -1 && level < ENGINE_LEVELS; level++) {
+            if (e->cores[source].ready[level]->count > 0) index = queue_pop(e, count, e->cores[source].ready[level]);
+        }
+        e->cores[source].ready_count--;
+
+        Thread *t = &threads->arr[index];
+        start_on_core(e, count, k, t);
+        int run = ENGINE_SLICE(t, e->quantum);
+        if (run >= t->remaining) run = t->remaining;
+        else { ENGINE_ON_PREEMPT(t); }
+        run_slice(e, count, index, run);
+        finish_on_core(e, count, k, run);
+        if (e->cfg->verbose) flush_verbose_cores(e);
+    }
+}
+
+ENGINE_VARIANTS(ENGINE_CORES_LOOP_NAME)
+
+#endif
+
+#undef ENGINE_VARIANTS
+#undef ENGINE_LOOP_NAME
+#undef ENGINE_CORES_LOOP_NAME
+#undef ENGINE_SINGLE_QUEUE
+#undef ENGINE_SLICE
+#undef ENGINE_READY_KEY
+#undef ENGINE_LEVELS
+#undef ENGINE_READY_LEVEL
+#undef ENGINE_PREEMPT_ON_ARRIVAL
+#undef ENGINE_ON_PREEMPT
+#undef ENGINE_FAST_FORWARD
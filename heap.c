@@ -0,0 +1,103 @@
+/**
+ * heap.c
+ * Ready queue implementation - see heap.h
+ *
+ * SOURCES:
+ * - Originally inspired by https://gist.github.com/sudhanshuptl/d86da25da46aa3d060e7be876bbdb343
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "heap.h"
+
+PriorityQueue *CreateHeap(int capacity){
+    PriorityQueue *h = (PriorityQueue*) malloc(sizeof(PriorityQueue));
+
+    //check if memory allocation is fails
+    if(h == NULL){
+        fprintf(stderr, "Memory Error!\n");
+        return NULL;
+    }
+    if (capacity < 1) capacity = HEAP_INITIAL_CAPACITY;
+    h->count = 0;
+    h->capacity = capacity;
+    h->arr = malloc(capacity * sizeof(HeapNode)); //size in bytes
+
+    //check if allocation succeed
+    if ( h->arr == NULL){
+        fprintf(stderr, "Memory Error!\n");
+        free(h);
+        return NULL;
+    }
+    return h;
+}
+
+void FreeHeap(PriorityQueue *h) {
+    if (h == NULL) return;
+    if (h->arr != NULL) free(h->arr);
+    free(h);
+}
+
+// adds the key to the queue, doubling the storage when it is full
+void insert(PriorityQueue *pq, HeapNode key){
+    if (pq->count == pq->capacity) {
+        HeapNode *grown = realloc(pq->arr, 2 * (size_t)pq->capacity * sizeof(HeapNode));
+        if (grown == NULL) {
+            fprintf(stderr, "realloc() failed for growing the Priority Queue.\n");
+            exit(-1);
+        }
+        pq->arr = grown;
+        pq->capacity *= 2;
+    }
+    pq->arr[pq->count] = key;
+    up_heap(pq, pq->count);
+    pq->count++;
+}
+
+// moves the node at index up until its parent is smaller (hole-based, no swaps)
+void up_heap(PriorityQueue *h, int index){
+    HeapNode moving = h->arr[index];
+    while (index > 0) {
+        int parent_node = (index - 1) / HEAP_ARITY;
+        if (!node_less(&moving, &h->arr[parent_node])) break;
+        h->arr[index] = h->arr[parent_node];
+        index = parent_node;
+    }
+    h->arr[index] = moving;
+}
+
+// parent_node is the index of the node to move down until all of its children are larger
+void down_heap(PriorityQueue *h, int parent_node){
+    HeapNode moving = h->arr[parent_node];
+    int count = h->count;
+    for (;;) {
+        int first = parent_node * HEAP_ARITY + 1;
+        if (first >= count) break;
+        int last = first + HEAP_ARITY < count ? first + HEAP_ARITY : count;
+        int min = first;
+        int child;
+        for (child = first + 1; child < last; child++) {
+            if (node_less(&h->arr[child], &h->arr[min])) min = child;
+        }
+        if (!node_less(&h->arr[min], &moving)) break;
+        h->arr[parent_node] = h->arr[min];
+        parent_node = min;
+    }
+    h->arr[parent_node] = moving;
+}
+
+// removes the smallest node and returns its thread table index, or -1 if the queue is empty
+int PopMin(PriorityQueue *h){
+    int pop;
+    if(h == NULL || h->arr == NULL || h->count == 0){ // return -1 if empty or invalid
+        return -1;
+    }
+    // replace first node by last and delete last
+    pop = h->arr[0].index;
+    h->count--;
+    if (h->count > 0) {
+        h->arr[0] = h->arr[h->count];
+        down_heap(h, 0);
+    }
+    return pop;
+}
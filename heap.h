@@ -0,0 +1,45 @@
+/**
+ * heap.h
+ * Growable d-ary min-heap used for the simulator's queues. Each node stores its ordering key
+ * inline (a key, process number, thread number) together with the index of the Thread in the
+ * caller's thread table, so sifting never dereferences a Thread. The key is the arrival time
+ * for a queue of arriving threads, or whatever a scheduling policy orders its ready queue by.
+ * Nodes are ordered by key, then process number, then thread number, then index,
+ * and the same comparison is used when sifting up and down.
+ */
+
+#ifndef HEAP_H
+#define HEAP_H
+
+#define HEAP_ARITY 4 // children per node; 4 keeps a node's children within one cache line
+#define HEAP_INITIAL_CAPACITY 1024
+
+typedef struct heap_node {
+    int key; // arrival time, or the scheduling policy's key
+    int process_num;
+    int thread_num;
+    int index; // slot of the Thread in the thread table
+} HeapNode;
+
+// returns non-zero if node a should leave the queue before node b
+static inline int node_less(const HeapNode *a, const HeapNode *b) {
+    if (a->key != b->key) return a->key < b->key;
+    if (a->process_num != b->process_num) return a->process_num < b->process_num;
+    if (a->thread_num != b->thread_num) return a->thread_num < b->thread_num;
+    return a->index < b->index;
+}
+
+typedef struct heap_struct {
+    HeapNode *arr;
+    int count;
+    int capacity;
+} PriorityQueue;
+
+PriorityQueue *CreateHeap(int capacity);
+void FreeHeap(PriorityQueue *h);
+void insert(PriorityQueue *h, HeapNode key);
+void up_heap(PriorityQueue *h, int index);
+void down_heap(PriorityQueue *h, int parent_node);
+int PopMin(PriorityQueue *h);
+
+#endif
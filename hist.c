@@ -0,0 +1,48 @@
+/**
+ * hist.c
+ * Log-bucketed histogram implementation - see hist.h
+ */
+
+#include <string.h>
+#include "hist.h"
+
+void hist_init(Histogram *h) {
+    memset(h, 0, sizeof(Histogram));
+}
+
+// adds every value recorded in from to into
+void hist_merge(Histogram *into, const Histogram *from) {
+    int i;
+    if (from->count == 0) return;
+    for (i = 0; i < HIST_BUCKETS; i++) into->counts[i] += from->counts[i];
+    if (into->count == 0 || from->min < into->min) into->min = from->min;
+    if (into->count == 0 || from->max > into->max) into->max = from->max;
+    into->count += from->count;
+    into->total += from->total;
+}
+
+// highest value in the bucket
+static int bucket_top(int bucket) {
+    if (bucket < HIST_SUB_BUCKETS) return bucket;
+    int group = bucket / HIST_SUB_BUCKETS;
+    long bottom = (long)(HIST_SUB_BUCKETS + bucket % HIST_SUB_BUCKETS) << (group - 1);
+    return (int)(bottom + (1L << (group - 1)) - 1);
+}
+
+// Smallest value that percent of the values are at or below, to within the width of its bucket
+// (the top of the bucket, but never past the largest value recorded). 0 if the histogram is empty.
+int hist_percentile(const Histogram *h, double percent) {
+    int i;
+    if (h->count == 0) return 0;
+    long rank = (long)(percent / 100.0 * h->count + 0.999999); // values at or below the answer
+    if (rank < 1) rank = 1;
+    long seen = 0;
+    for (i = 0; i < HIST_BUCKETS; i++) {
+        seen += h->counts[i];
+        if (seen >= rank) break;
+    }
+    int top = i < HIST_BUCKETS ? bucket_top(i) : h->max;
+    if (top > h->max) top = h->max;
+    if (top < h->min) top = h->min;
+    return top;
+}
@@ -0,0 +1,46 @@
+/**
+ * hist.h
+ * Log-bucketed histogram of non-negative times, for percentiles over any number of values in
+ * constant memory. Values below HIST_SUB_BUCKETS have a bucket each; above that, every power of two
+ * is split into HIST_SUB_BUCKETS buckets of equal width, so a percentile is never off by more than
+ * 1 / HIST_SUB_BUCKETS of its value. Adding a value is O(1), and histograms of separate runs (or
+ * parts of one) can be merged by adding their buckets.
+ */
+
+#ifndef HIST_H
+#define HIST_H
+
+#define HIST_SUB_BITS 5
+#define HIST_SUB_BUCKETS (1 << HIST_SUB_BITS)
+#define HIST_BUCKETS ((32 - HIST_SUB_BITS) * HIST_SUB_BUCKETS) // covers every non-negative int
+
+typedef struct histogram_struct {
+    long counts[HIST_BUCKETS];
+    long count;
+    long total;
+    int min;
+    int max;
+} Histogram;
+
+// bucket holding the (non-negative) value
+static inline int hist_bucket(int value) {
+    if (value < HIST_SUB_BUCKETS) return value;
+    int group = 31 - __builtin_clz((unsigned int)value) - HIST_SUB_BITS + 1; // 1 for [32, 64), ...
+    return group * HIST_SUB_BUCKETS + (value >> (group - 1)) - HIST_SUB_BUCKETS;
+}
+
+// records one value; negative values count as 0
+static inline void hist_add(Histogram *h, int value) {
+    if (value < 0) value = 0;
+    h->counts[hist_bucket(value)]++;
+    if (h->count == 0 || value < h->min) h->min = value;
+    if (h->count == 0 || value > h->max) h->max = value;
+    h->count++;
+    h->total += value;
+}
+
+void hist_init(Histogram *h);
+void hist_merge(Histogram *into, const Histogram *from);
+int hist_percentile(const Histogram *h, double percent);
+
+#endif
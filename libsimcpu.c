@@ -0,0 +1,367 @@
+/**
+ * libsimcpu.c
+ * Embeddable simulator interface - see libsimcpu.h
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <errno.h>
+#include "libsimcpu.h"
+#include "engine.h"
+#include "loader.h"
+#include "binfmt.h"
+#include "report.h"
+#include "output.h"
+#include "checkpoint.h"
+#include "stats.h"
+
+struct simcpu_context {
+    Workload w;
+    bool loaded;
+    void *data;        // copy of a binary workload given in memory, whose bursts are used in place
+    WorkloadReader *stream; // input read by the next run (simcpu_open_stream), or NULL
+    bool streamed;     // the workload was read by a run, which released its threads as they finished
+    bool resumed;      // the next run carries on from resume (simcpu_resume)
+    SimState resume;
+    LoadStats load_stats;
+    double parse_seconds;
+    // of the last run
+    PolicyKind policy;
+    Report report;
+    SimResult result;
+    double simulate_seconds;
+    double run_end;    // when it ended, for the time spent reporting it (see simcpu_write_stats)
+    bool counted;      // it succeeded with count, so there are statistics to write
+    OutputWriter output; // open from the run until simcpu_close_output, the next run or simcpu_destroy
+    bool output_open;
+    const char *checkpoint_path;
+    char error[256];   // as long as a LoadError message
+};
+
+// records why the call failed (a printf format) and returns -1
+static int fail(SimcpuContext *ctx, const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    vsnprintf(ctx->error, sizeof(ctx->error), format, args);
+    va_end(args);
+    return -1;
+}
+
+SimcpuContext *simcpu_create(void) {
+    SimcpuContext *ctx = calloc(1, sizeof(SimcpuContext));
+    if (ctx == NULL) {
+        fprintf(stderr, "malloc() failed for a simulator context.\n");
+        exit(-1);
+    }
+    report_init(&ctx->report, false);
+    return ctx;
+}
+
+// frees the workload and everything kept from the last run
+static void unload(SimcpuContext *ctx) {
+    if (ctx->stream != NULL) close_workload(ctx->stream, NULL);
+    ctx->stream = NULL;
+    if (ctx->loaded) free_workload(&ctx->w);
+    free(ctx->data);
+    ctx->data = NULL;
+    ctx->loaded = false;
+    ctx->streamed = false;
+    ctx->resumed = false;
+    memset(&ctx->load_stats, 0, sizeof(LoadStats));
+    ctx->parse_seconds = 0;
+    report_free(&ctx->report);
+    free_sim_result(&ctx->result);
+    ctx->counted = false;
+}
+
+void simcpu_destroy(SimcpuContext *ctx) {
+    if (ctx == NULL) return;
+    simcpu_close_output(ctx);
+    unload(ctx);
+    free(ctx);
+}
+
+// loads the workload from data, or from the file at path if data is NULL, keeping the reason it is bad
+static int load(SimcpuContext *ctx, const char *path, const void *data, size_t size) {
+    LoadError err;
+    if (load_workload_checked(path, data, size, "workload", &ctx->w, &ctx->load_stats, &err) != 0) {
+        free(ctx->data);
+        ctx->data = NULL;
+        return fail(ctx, "%s", err.message);
+    }
+    ctx->loaded = true;
+    ctx->parse_seconds = ctx->load_stats.seconds;
+    return 0;
+}
+
+// Loads a workload in the text or binary input format from memory, replacing any loaded before.
+// The data is not used after the call returns. Returns 0, or -1 if the input is malformed.
+int simcpu_load(SimcpuContext *ctx, const void *data, size_t size) {
+    if (data == NULL) return fail(ctx, "no workload given");
+    unload(ctx);
+    if (is_binary_workload(data, size)) { // keep a copy for the bursts to point into
+        ctx->data = malloc(size);
+        if (ctx->data == NULL) {
+            fprintf(stderr, "malloc() failed for a copy of the workload.\n");
+            exit(-1);
+        }
+        memcpy(ctx->data, data, size);
+        data = ctx->data;
+    }
+    return load(ctx, NULL, data, size);
+}
+
+// as simcpu_load, from the file at path (text or binary), or stdin if path is NULL; also -1 if it cannot be read
+int simcpu_load_file(SimcpuContext *ctx, const char *path) {
+    unload(ctx);
+    return load(ctx, path, NULL, 0);
+}
+
+// Opens the file at path (stdin if NULL), whose threads must be sorted by arrival time, in place of
+// a loaded workload: the next run reads each thread as the simulation reaches it and releases it once
+// it terminates, so the whole input is never held at once. Returns 0, or -1 if it cannot be opened.
+int simcpu_open_stream(SimcpuContext *ctx, const char *path) {
+    LoadError err;
+    unload(ctx);
+    memset(&ctx->w, 0, sizeof(Workload));
+    if (setjmp(err.jump) != 0) {
+        if (err.reader != NULL) close_workload(err.reader, NULL);
+        free_workload(&ctx->w);
+        return fail(ctx, "%s", err.message);
+    }
+    catch_load_errors(&err);
+    ctx->stream = open_workload(path, &ctx->w, true);
+    release_load_errors(&err);
+    ctx->loaded = true;
+    return 0;
+}
+
+// Reads a checkpoint of the loaded workload saved by a run with checkpoint_path: the next run carries
+// on from it rather than from the start, under any policy. Returns 0 with the time it was saved at
+// in *time, or -1 if it cannot be read or was saved from another workload.
+int simcpu_resume(SimcpuContext *ctx, const char *path, int *time) {
+    LoadError err;
+    if (ctx->loaded == false || ctx->stream != NULL || ctx->streamed) return fail(ctx, "no workload loaded to resume");
+    ctx->resumed = false;
+    if (setjmp(err.jump) != 0) return fail(ctx, "%s", err.message);
+    catch_load_errors(&err);
+    read_checkpoint(path, &ctx->w, &ctx->resume);
+    release_load_errors(&err);
+    ctx->resumed = true;
+    *time = ctx->resume.time_total;
+    return 0;
+}
+
+// processes in the loaded (or opened) workload, 0 if there is none
+int simcpu_process_count(const SimcpuContext *ctx) {
+    return ctx->loaded ? ctx->w.num_processes : 0;
+}
+
+// sets the defaults: FCFS on one core with the workload's switch times and nothing extra kept
+void simcpu_config_init(SimcpuConfig *cfg) {
+    memset(cfg, 0, sizeof(SimcpuConfig));
+    cfg->policy = "fcfs";
+    cfg->cores = 1;
+    cfg->same_switch = -1;
+    cfg->diff_switch = -1;
+}
+
+static void fill_times(SimcpuTimes *times, const Histogram *h) {
+    times->threads = h->count;
+    times->mean = h->count > 0 ? (double)h->total / h->count : 0.0;
+    times->min = h->min;
+    times->p50 = hist_percentile(h, 50);
+    times->p90 = hist_percentile(h, 90);
+    times->p99 = hist_percentile(h, 99);
+    times->p999 = hist_percentile(h, 99.9);
+    times->max = h->max;
+}
+
+// builds the engine's configuration; returns why cfg cannot be run, or NULL if it can
+static const char *configure(const SimcpuConfig *cfg, SimConfig *sim) {
+    memset(sim, 0, sizeof(SimConfig));
+    if (cfg->policy == NULL || parse_policy(cfg->policy, &sim->policy) == 0) return "unknown policy";
+    if (cfg->quantum < 0 || (sim->policy == POLICY_RR && cfg->quantum == 0)) return "round robin needs a positive quantum";
+    if (cfg->cores < 1) return "there must be at least one core";
+    if (cfg->cores > 1 && policy_supports_cores(sim->policy) == false) return "policy can only be simulated on one core";
+    if (cfg->migration_cost < 0) return "migration cost cannot be negative";
+    if (cfg->max_resident < 0) return "the resident thread limit cannot be negative";
+    if (cfg->checkpoint_path != NULL && cfg->checkpoint_time < 0) return "checkpoint time cannot be negative";
+    sim->quantum = cfg->quantum;
+    sim->cores = cfg->cores;
+    sim->migration_cost = cfg->migration_cost;
+    return NULL;
+}
+
+// Prints the line simcpu starts its output with, naming the policy of cfg (and its quantum and
+// cores). Returns 0, or -1 if cfg cannot be run.
+int simcpu_print_policy(const SimcpuConfig *cfg, FILE *out) {
+    SimConfig sim;
+    if (configure(cfg, &sim) != NULL) return -1;
+    print_policy_header(&sim, out);
+    return 0;
+}
+
+// pause callback of the simulation: saves its state to the context's checkpoint file
+static void save_checkpoint(const Workload *w, const SimState *state, void *arg) {
+    SimcpuContext *ctx = arg;
+    if (write_checkpoint(ctx->checkpoint_path, w, state) != 0) fail(ctx, "%s: %s", ctx->checkpoint_path, strerror(errno));
+}
+
+// Simulates the loaded workload under cfg, from the start or from the checkpoint given to
+// simcpu_resume, and fills in res. Returns 0, or -1 if the configuration cannot be run, a streamed
+// input turns out to be bad or the checkpoint cannot be saved (see simcpu_error).
+int simcpu_run(SimcpuContext *ctx, const SimcpuConfig *cfg, SimcpuResults *res) {
+    SimConfig sim;
+    OutputFormat format = FORMAT_TEXT;
+    if (ctx->loaded == false) return fail(ctx, "no workload loaded");
+    if (ctx->streamed) return fail(ctx, "the streamed workload was already simulated");
+    const char *unusable = configure(cfg, &sim);
+    if (unusable != NULL) return fail(ctx, "%s", unusable);
+    if (cfg->output_format != NULL && parse_output_format(cfg->output_format, &format) == 0) {
+        return fail(ctx, "unknown output format");
+    }
+    if (cfg->checkpoint_path != NULL && (ctx->stream != NULL || cfg->cores > 1 || ctx->resumed)) {
+        return fail(ctx, "a checkpoint can only be saved from the start of a loaded workload on one core");
+    }
+
+    Workload *w = &ctx->w;
+    int same_switch = w->units_same_switch;
+    int diff_switch = w->units_diff_switch;
+    if (cfg->same_switch >= 0) w->units_same_switch = cfg->same_switch;
+    if (cfg->diff_switch >= 0) w->units_diff_switch = cfg->diff_switch;
+    if (ctx->resumed == false) reset_workload(w);
+    report_free(&ctx->report);
+    report_init(&ctx->report, cfg->keep_threads != 0);
+    free_sim_result(&ctx->result);
+    ctx->counted = false;
+    simcpu_close_output(ctx);
+
+    sim.verbose = cfg->output != NULL && cfg->events != 0;
+    sim.detailed = cfg->keep_threads != 0;
+    sim.count = cfg->count != 0;
+    sim.max_resident = cfg->max_resident;
+    if (cfg->output != NULL) {
+        output_init(&ctx->output, cfg->output, format);
+        ctx->output_open = true;
+        sim.out = &ctx->output;
+    }
+    if (cfg->checkpoint_path != NULL) {
+        ctx->checkpoint_path = cfg->checkpoint_path;
+        sim.on_pause = save_checkpoint;
+        sim.pause_time = cfg->checkpoint_time;
+        sim.pause_arg = ctx;
+    }
+    if (ctx->resumed) sim.resume = &ctx->resume;
+    ctx->error[0] = '\0';
+    double start = stats_clock();
+    int status = run_simulation(w, ctx->stream, &sim, &ctx->report, &ctx->result);
+    ctx->run_end = stats_clock();
+    ctx->simulate_seconds = ctx->run_end - start;
+    ctx->policy = sim.policy;
+    ctx->resumed = false;
+    w->units_same_switch = same_switch;
+    w->units_diff_switch = diff_switch;
+    if (ctx->stream != NULL) { // its input was read during the run
+        close_workload(ctx->stream, &ctx->load_stats);
+        ctx->stream = NULL;
+        ctx->streamed = true;
+    }
+    if (status != 0) return fail(ctx, "%s", ctx->result.error);
+    if (ctx->error[0] != '\0') return -1; // the checkpoint was not saved
+    if (cfg->checkpoint_path != NULL && ctx->result.time_total < cfg->checkpoint_time) {
+        return fail(ctx, "the simulation ended at time %d, before the checkpoint time %d", ctx->result.time_total,
+                cfg->checkpoint_time);
+    }
+
+    ctx->counted = sim.count;
+    const SimResult *result = &ctx->result;
+    memset(res, 0, sizeof(SimcpuResults));
+    res->time_total = result->time_total;
+    res->cpu_time_total = result->cpu_time_total;
+    if (w->num_processes > 0) res->average_turnaround = (double)report_turnaround_total(&ctx->report) / w->num_processes;
+    if (result->time_total > 0) res->cpu_utilization = 100 * (double)result->cpu_time_total / ((double)result->time_total * cfg->cores);
+    res->dispatches = result->dispatches;
+    res->threads = result->threads_read;
+    res->cores = result->core_stats != NULL ? result->num_cores : 0;
+    fill_times(&res->turnaround, &ctx->report.turnaround);
+    fill_times(&res->waiting, &ctx->report.waiting);
+    fill_times(&res->response, &ctx->report.response);
+    res->same_switches = result->counters.same_switches;
+    res->diff_switches = result->counters.diff_switches;
+    res->preemptions = result->counters.preemptions;
+    res->bursts_completed = result->counters.bursts_completed;
+    res->idle_time = result->counters.idle_time;
+    return 0;
+}
+
+// threads kept by the last run (with keep_threads), in the order they finished
+int simcpu_thread_count(const SimcpuContext *ctx) {
+    return ctx->report.count;
+}
+
+// fills in the result of the i-th thread kept by the last run; returns 0, or -1 if there is none
+int simcpu_thread(const SimcpuContext *ctx, int i, SimcpuThreadResult *out) {
+    if (i < 0 || i >= ctx->report.count) return -1;
+    const ThreadSummary *s = &ctx->report.summaries[i];
+    out->process_num = s->process_num;
+    out->thread_num = s->thread_num;
+    out->arrival_time = s->arrival_time;
+    out->service_time = s->service_time;
+    out->io_time = s->io_time;
+    out->finish_time = s->time_finished;
+    return 0;
+}
+
+// fills in the results of core i of the last run (see SimcpuResults.cores); returns 0, or -1 if there is none
+int simcpu_core(const SimcpuContext *ctx, int i, SimcpuCoreResult *out) {
+    const SimResult *result = &ctx->result;
+    if (result->core_stats == NULL || i < 0 || i >= result->num_cores) return -1;
+    const CoreStats *core = &result->core_stats[i];
+    out->utilization = result->time_total > 0 ? 100 * (double)core->busy / (double)result->time_total : 0.0;
+    out->dispatches = core->dispatches;
+    out->migrations = core->migrations;
+    out->steals = core->steals;
+    return 0;
+}
+
+// Writes the threads kept by the last run (with keep_threads) to its output, in the order of their
+// process and thread numbers, which simcpu_thread then follows too. Returns 0, or -1 if the run kept
+// no threads or had no output.
+int simcpu_write_threads(SimcpuContext *ctx) {
+    if (ctx->output_open == false || ctx->report.keep_summaries == false) return fail(ctx, "no threads kept to write");
+    report_print_details(&ctx->report, &ctx->output);
+    return 0;
+}
+
+// Writes the statistics of the last run (with count) as text and as JSON (see stats.h), to either
+// or both of the files; the time spent reporting is the time since the run ended. Returns 0, or -1
+// if the run did not count.
+int simcpu_write_stats(SimcpuContext *ctx, FILE *text, FILE *json) {
+    RunStats stats;
+    if (ctx->counted == false) return fail(ctx, "the last run was not counted");
+    stats.policy = ctx->policy;
+    stats.load = ctx->load_stats;
+    stats.streamed = ctx->streamed;
+    stats.resident_max = ctx->w.threads.resident_max;
+    stats.res = &ctx->result;
+    stats.report = &ctx->report;
+    stats.parse_seconds = ctx->streamed ? 0.0 : ctx->parse_seconds;
+    stats.simulate_seconds = ctx->simulate_seconds;
+    stats.report_seconds = stats_clock() - ctx->run_end;
+    if (text != NULL) print_stats(&stats, text);
+    if (json != NULL) write_stats_json(&stats, json);
+    return 0;
+}
+
+// completes the output of the last run (the end of a trace), if it is still open
+void simcpu_close_output(SimcpuContext *ctx) {
+    if (ctx->output_open) output_finish(&ctx->output);
+    ctx->output_open = false;
+}
+
+// why the last call that returned -1 failed
+const char *simcpu_error(const SimcpuContext *ctx) {
+    return ctx->error;
+}
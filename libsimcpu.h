@@ -0,0 +1,116 @@
+/**
+ * libsimcpu.h
+ * Interface for embedding the simulator (libsimcpu.a, "make libsimcpu.a") in another program, from
+ * C or C++; the simcpu command line tool is built on it. A SimcpuContext holds one workload, loaded
+ * from memory or a file, and the results of the last simulation run on it; it can be run any number
+ * of times with different configurations. A workload opened as a stream (simcpu_open_stream) is
+ * instead read while it is simulated, and can only be run once.
+ * Contexts share nothing, so any number of them can be used at once from different threads, as long
+ * as each context is only used by one thread at a time.
+ *
+ * A configuration the simulator cannot run (an unknown policy, round robin without a quantum, ...)
+ * makes simcpu_run return -1, with the reason given by simcpu_error, and so does bad input found
+ * while streaming. Malformed or unreadable input makes simcpu_load, simcpu_load_file and
+ * simcpu_open_stream return -1 too, leaving no workload loaded. As in the command line tool, failed
+ * allocations end the process with a message on stderr.
+ */
+
+#ifndef LIBSIMCPU_H
+#define LIBSIMCPU_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct simcpu_context SimcpuContext;
+
+typedef struct simcpu_config_struct {
+    const char *policy;  // "fcfs", "rr", "sjf", "srtf", "priority" or "mlfq"
+    int quantum;         // round robin quantum (needed), or the mlfq base quantum (0 for the default)
+    int cores;           // simulated CPUs
+    int migration_cost;  // extra switch time when a thread moves to another core
+    int same_switch;     // context switch times, -1 for those of the workload
+    int diff_switch;
+    int count;           // non-zero to fill in the counters of the results
+    int keep_threads;    // non-zero to keep a result for every thread (see simcpu_thread)
+    FILE *output;        // if not NULL, the events and thread results are written here...
+    const char *output_format; // ...as "text" (NULL), "csv", "jsonl" or "trace" (see output.h)
+    int events;          // non-zero to write every state transition to output during the run
+    int max_resident;    // with a stream, fail if more threads than this are held at once (0 = no limit)
+    const char *checkpoint_path; // if not NULL, the state at checkpoint_time is saved to this file...
+    int checkpoint_time;         // ...(a loaded workload on one core, see simcpu_resume)
+} SimcpuConfig;
+
+// distribution of one time over the finished threads (percentiles within about 3%, see hist.h)
+typedef struct simcpu_times_struct {
+    long threads;
+    double mean;
+    int min;
+    int p50;
+    int p90;
+    int p99;
+    int p999;
+    int max;
+} SimcpuTimes;
+
+typedef struct simcpu_results_struct {
+    int time_total;
+    int cpu_time_total;
+    double average_turnaround; // per process, as printed by simcpu
+    double cpu_utilization;    // percent, averaged over the cores
+    long dispatches;
+    int threads;
+    int cores;                 // cores with results of their own (see simcpu_core), 0 on one core
+    SimcpuTimes turnaround;    // finish - arrival
+    SimcpuTimes waiting;       // turnaround less CPU and I/O time
+    SimcpuTimes response;      // first time on the CPU - arrival
+    // only filled in with count
+    long same_switches;
+    long diff_switches;
+    long preemptions;
+    long bursts_completed;
+    long idle_time;
+} SimcpuResults;
+
+typedef struct simcpu_thread_result_struct {
+    int process_num;
+    int thread_num;
+    int arrival_time;
+    int service_time;
+    int io_time;
+    int finish_time;
+} SimcpuThreadResult;
+
+typedef struct simcpu_core_result_struct {
+    double utilization; // percent of the total time
+    long dispatches;
+    long migrations;    // threads put on this core that last ran on another one
+    long steals;        // threads taken from another core's run queue
+} SimcpuCoreResult;
+
+SimcpuContext *simcpu_create(void);
+void simcpu_destroy(SimcpuContext *ctx);
+int simcpu_load(SimcpuContext *ctx, const void *data, size_t size);
+int simcpu_load_file(SimcpuContext *ctx, const char *path);
+int simcpu_open_stream(SimcpuContext *ctx, const char *path);
+int simcpu_resume(SimcpuContext *ctx, const char *path, int *time);
+int simcpu_process_count(const SimcpuContext *ctx);
+void simcpu_config_init(SimcpuConfig *cfg);
+int simcpu_print_policy(const SimcpuConfig *cfg, FILE *out);
+int simcpu_run(SimcpuContext *ctx, const SimcpuConfig *cfg, SimcpuResults *res);
+int simcpu_thread_count(const SimcpuContext *ctx);
+int simcpu_thread(const SimcpuContext *ctx, int i, SimcpuThreadResult *out);
+int simcpu_core(const SimcpuContext *ctx, int i, SimcpuCoreResult *out);
+int simcpu_write_threads(SimcpuContext *ctx);
+int simcpu_write_stats(SimcpuContext *ctx, FILE *text, FILE *json);
+void simcpu_close_output(SimcpuContext *ctx);
+const char *simcpu_error(const SimcpuContext *ctx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,467 @@
+/**
+ * loader.c
+ * Text workload loader - see loader.h
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "loader.h"
+#include "binfmt.h"
+
+#define READ_CHUNK (1 << 20) // bytes requested per read() for streamed input
+#define MAX_VALUES 3         // no line of the format holds more numbers than this
+
+typedef struct scanner_struct {
+    const char *p;    // next unread byte
+    const char *end;  // end of the bytes available
+    char *buf;        // read buffer, NULL when the input is memory mapped
+    size_t buf_size;
+    int fd;
+    int eof;          // nothing more can be read into the buffer
+    long line_num;    // number of the last line returned
+    size_t bytes_read; // total read into the buffer so far
+    const char *name; // input name for error messages
+} Scanner;
+
+// where bad input is reported on this thread: NULL to print it and exit, as the command line tool does
+static __thread LoadError *load_handler;
+
+// Reports bad input (a printf format, without "ERROR: " or a newline): returns to the handler set on
+// this thread by catch_load_errors with the message, or prints it and exits if there is none.
+void load_error(const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    if (load_handler != NULL) {
+        LoadError *err = load_handler;
+        load_handler = err->outer;
+        vsnprintf(err->message, sizeof(err->message), format, args);
+        va_end(args);
+        longjmp(err->jump, 1);
+    }
+    fprintf(stderr, "ERROR: ");
+    vfprintf(stderr, format, args);
+    va_end(args);
+    fprintf(stderr, "\n");
+    exit(-1);
+}
+
+static void parse_error(const Scanner *s, const char *message) {
+    load_error("%s:%ld: %s", s->name, s->line_num, message);
+}
+
+// moves the unread bytes to the front of the buffer and reads more after them
+static void refill(Scanner *s) {
+    size_t unread = s->end - s->p;
+    if (s->p != s->buf) memmove(s->buf, s->p, unread);
+    if (s->buf_size - unread < READ_CHUNK / 2) { // make room for a whole chunk
+        char *grown = realloc(s->buf, s->buf_size * 2);
+        if (grown == NULL) {
+            fprintf(stderr, "realloc() failed for growing the input buffer.\n");
+            exit(-1);
+        }
+        s->buf = grown;
+        s->buf_size *= 2;
+    }
+    ssize_t got = read(s->fd, s->buf + unread, s->buf_size - unread);
+    if (got < 0) {
+        if (load_handler != NULL) load_error("%s: %s", s->name, strerror(errno));
+        perror("read");
+        exit(-1);
+    }
+    if (got == 0) s->eof = 1;
+    s->bytes_read += got;
+    s->p = s->buf;
+    s->end = s->buf + unread + got;
+}
+
+// parses the numbers on the next non-blank line into vals and returns how many there were,
+// or -1 at the end of the input
+static int next_line(Scanner *s, int *vals) {
+    for (;;) {
+        const char *newline = memchr(s->p, '\n', s->end - s->p);
+        if (newline == NULL && !s->eof) {
+            refill(s);
+            continue;
+        }
+        if (newline == NULL && s->p == s->end) return -1;
+        const char *line_end = newline != NULL ? newline : s->end;
+        const char *c = s->p;
+        int count = 0;
+        s->line_num++;
+        while (c < line_end) {
+            if (*c == ' ' || *c == '\t' || *c == '\r') {
+                c++;
+                continue;
+            }
+            int negative = 0;
+            long value = 0;
+            if (*c == '-') {
+                negative = 1;
+                c++;
+            }
+            if (c == line_end || *c < '0' || *c > '9') parse_error(s, "expected an integer");
+            while (c < line_end && *c >= '0' && *c <= '9') {
+                value = value * 10 + (*c - '0');
+                if (value > INT_MAX) parse_error(s, "integer is too large");
+                c++;
+            }
+            if (c < line_end && *c != ' ' && *c != '\t' && *c != '\r') parse_error(s, "expected an integer");
+            if (count == MAX_VALUES) parse_error(s, "too many values on line");
+            vals[count++] = negative ? (int)-value : (int)value;
+        }
+        s->p = newline != NULL ? newline + 1 : s->end;
+        if (count > 0) return count;
+    }
+}
+
+// returns an uninitialised Thread slot, reusing a released one if possible, and stores its index;
+// the table may grow, so earlier Thread pointers can move
+Thread *add_thread(ThreadTable *threads, int *index) {
+    if (threads->free_count > 0) {
+        *index = threads->free_slots[--threads->free_count];
+    } else {
+        if (threads->count == threads->capacity) {
+            int capacity = threads->capacity > 0 ? threads->capacity * 2 : 1024;
+            Thread *grown = realloc(threads->arr, capacity * sizeof(Thread));
+            int *grown_slots = realloc(threads->free_slots, capacity * sizeof(int));
+            if (grown == NULL || grown_slots == NULL) {
+                fprintf(stderr, "realloc() failed for growing the thread table.\n");
+                exit(-1);
+            }
+            threads->arr = grown;
+            threads->free_slots = grown_slots;
+            threads->capacity = capacity;
+        }
+        *index = threads->count++;
+    }
+    if (resident_threads(threads) > threads->resident_max) threads->resident_max = resident_threads(threads);
+    return &threads->arr[*index];
+}
+
+// number of threads currently held in the table
+int resident_threads(const ThreadTable *threads) {
+    return threads->count - threads->free_count;
+}
+
+// when streaming, gives the slot of a terminated thread back to the table and its bursts back to the pool;
+// a fully loaded workload keeps every thread so it can be reset and simulated again
+void release_thread(Workload *w, int index) {
+    Thread *t = &w->threads.arr[index];
+    if (w->streaming == false) return;
+    if (w->recycle) pool_free(&w->burst_pool, t->cpu_burst_times, 2 * (size_t)t->burst_num * sizeof(int));
+    t->cpu_burst_times = NULL;
+    t->io_burst_times = NULL;
+    w->threads.free_slots[w->threads.free_count++] = index;
+}
+
+// reads one thread (its line and all of its bursts) into the table and returns its index
+static int read_thread(Scanner *s, Workload *w, int process_num, int num_threads) {
+    int vals[MAX_VALUES];
+    int n = next_line(s, vals);
+    int j, index;
+    if (n == -1) parse_error(s, "unexpected end of input, expected a thread");
+    if (n != 3) parse_error(s, "expected thread number, arrival time and number of CPU bursts");
+    if (vals[1] < 0) parse_error(s, "arrival time cannot be negative");
+    if (vals[2] < 1) parse_error(s, "a thread needs at least one CPU burst");
+
+    Thread *temp = add_thread(&w->threads, &index);
+    temp->process_num = process_num;
+    temp->num_threads = num_threads;
+    temp->thread_num = vals[0];
+    temp->arrival_time = vals[1];
+    temp->burst_num = vals[2];
+    // both burst arrays share one block
+    size_t burst_bytes = 2 * (size_t)temp->burst_num * sizeof(int);
+    temp->cpu_burst_times = w->recycle ? pool_alloc(&w->burst_pool, &w->arena, burst_bytes) : arena_alloc(&w->arena, burst_bytes);
+    temp->io_burst_times = temp->cpu_burst_times + temp->burst_num;
+    temp->original_arrival_time = temp->arrival_time;
+    temp->service_time = 0;
+    temp->io_time = 0;
+
+    // get the bursts, the last one has no I/O time
+    for (j = 0; j < temp->burst_num; j++) {
+        n = next_line(s, vals);
+        if (n == -1) parse_error(s, "unexpected end of input, expected a CPU burst");
+        if (j < temp->burst_num - 1 && n != 3) parse_error(s, "expected burst number, CPU time and I/O time");
+        if (n < 2) parse_error(s, "expected burst number and CPU time");
+        if (vals[1] < 0 || (j < temp->burst_num - 1 && vals[2] < 0)) parse_error(s, "burst times cannot be negative");
+        temp->cpu_burst_times[j] = vals[1];
+        temp->io_burst_times[j] = j < temp->burst_num - 1 ? vals[2] : 0;
+        temp->service_time += temp->cpu_burst_times[j];
+        temp->io_time += temp->io_burst_times[j];
+    }
+    reset_thread(temp);
+    return index;
+}
+
+// puts the thread back in its state before the simulation: not arrived, at its first burst
+void reset_thread(Thread *t) {
+    t->arrival_time = t->original_arrival_time;
+    t->current_burst = 0;
+    t->remaining = t->cpu_burst_times[0];
+    t->queue_level = 0;
+    t->core = -1;
+    t->time_enters_cpu = 0;
+    t->time_first_enters_cpu = -1;
+    t->time_finished = 0;
+}
+
+// resets every thread of a fully loaded workload so it can be simulated again
+void reset_workload(Workload *w) {
+    int i;
+    for (i = 0; i < w->threads.count; i++) {
+        if (w->threads.arr[i].cpu_burst_times != NULL) reset_thread(&w->threads.arr[i]);
+    }
+}
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+struct workload_reader_struct {
+    Scanner s;
+    void *map;              // mapping of the input file, NULL if not mapped
+    size_t map_size;
+    const char *data;       // the whole input when it is in memory (mapped or given), NULL otherwise
+    size_t data_size;
+    int binary;
+    BinColumns cols;        // binary input only
+    uint64_t next_binary;   // next thread to read from the columns
+    int process_num;        // text input only: process whose threads are being read
+    int process_threads;
+    int threads_left;
+    bool streaming;         // threads must come in order of arrival time
+    int last_arrival;
+    size_t released_bytes;  // how much of a mapped text file has been dropped from memory
+    double start;
+};
+
+#define RELEASE_STEP (64 << 20) // drop consumed input from memory in steps of this many bytes
+
+static WorkloadReader *new_reader(bool streaming) {
+    WorkloadReader *r = calloc(1, sizeof(WorkloadReader));
+    if (r == NULL) {
+        fprintf(stderr, "malloc() failed for the workload reader.\n");
+        exit(-1);
+    }
+    r->start = now_seconds();
+    r->streaming = streaming;
+    r->last_arrival = -1;
+    if (load_handler != NULL) load_handler->reader = r; // closed if the load fails
+    return r;
+}
+
+// sets up the workload and reads the first line of the input the reader was opened on
+static void start_workload(WorkloadReader *r, Workload *w, bool streaming) {
+    Scanner *s = &r->s;
+    int vals[MAX_VALUES];
+    memset(&w->threads, 0, sizeof(ThreadTable));
+    w->map = NULL;
+    w->map_size = 0;
+    w->streaming = streaming;
+    w->recycle = streaming;
+    arena_init(&w->arena);
+    pool_init(&w->burst_pool);
+
+    if (r->data != NULL && is_binary_workload(r->data, r->data_size)) {
+        open_binary_workload((void *)r->data, r->data_size, s->name, w, &r->cols);
+        r->binary = 1;
+        w->recycle = false; // bursts stay in the input
+        w->map = r->map; // the workload now owns the mapping, if any
+        w->map_size = r->map != NULL ? r->map_size : 0;
+        return;
+    }
+    if (r->data == NULL) {
+        refill(s);
+        if (is_binary_workload(s->p, s->end - s->p)) load_error("%s: binary workloads must be given by file name", s->name);
+    }
+
+    // first line always starts with the number of processes and the two switch costs
+    int n = next_line(s, vals);
+    if (n != 3) parse_error(s, "expected number of processes and two context switch times");
+    w->num_processes = vals[0];
+    w->units_same_switch = vals[1];
+    w->units_diff_switch = vals[2];
+    if (w->num_processes > 0 && (w->units_same_switch < 0 || w->units_diff_switch < 0)) load_error("Invalid first line in input");
+}
+
+// Opens the input at path (stdin if path is NULL) and reads its first line into the workload.
+// If streaming, the threads must appear in order of arrival time, and their burst arrays are
+// recycled by release_thread(). Exits with a message on bad input.
+WorkloadReader *open_workload(const char *path, Workload *w, bool streaming) {
+    WorkloadReader *r = new_reader(streaming);
+    Scanner *s = &r->s;
+    struct stat st;
+    s->name = path != NULL ? path : "stdin";
+    s->fd = path != NULL ? open(path, O_RDONLY) : STDIN_FILENO;
+    if (s->fd < 0) {
+        if (load_handler != NULL) load_error("%s: %s", path, strerror(errno));
+        perror(path);
+        exit(-1);
+    }
+    if (fstat(s->fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        r->map_size = st.st_size;
+        r->map = mmap(NULL, r->map_size, PROT_READ, MAP_PRIVATE, s->fd, 0);
+        if (r->map == MAP_FAILED) r->map = NULL; // fall back to reading
+    }
+    if (r->map != NULL) {
+        madvise(r->map, r->map_size, MADV_SEQUENTIAL);
+        r->data = r->map;
+        r->data_size = r->map_size;
+        s->p = r->data;
+        s->end = r->data + r->data_size;
+        s->eof = 1;
+    } else {
+        s->buf_size = READ_CHUNK;
+        s->buf = malloc(s->buf_size);
+        if (s->buf == NULL) {
+            fprintf(stderr, "malloc() failed for the input buffer.\n");
+            exit(-1);
+        }
+        s->p = s->end = s->buf;
+    }
+    start_workload(r, w, streaming);
+    return r;
+}
+
+// As open_workload, but for an input (text or binary) held in memory, named name in error messages.
+// The data must stay valid until the reader is closed, and for a binary workload until the workload
+// is freed, as its bursts are used in place.
+WorkloadReader *open_workload_memory(const void *data, size_t size, const char *name, Workload *w, bool streaming) {
+    WorkloadReader *r = new_reader(streaming);
+    Scanner *s = &r->s;
+    s->name = name;
+    s->fd = -1;
+    r->data = data;
+    r->data_size = size;
+    s->p = r->data;
+    s->end = r->data + size;
+    s->eof = 1;
+    start_workload(r, w, streaming);
+    return r;
+}
+
+// Reads the next thread of the workload into its thread table and returns its index, or -1 once
+// there are no more. If the number of processes is not positive, there are no threads.
+int read_next_thread(WorkloadReader *r, Workload *w) {
+    int index;
+    if (w->num_processes <= 0) return -1;
+    if (r->binary) {
+        if (r->next_binary == r->cols.num_threads) return -1;
+        Thread *t = add_thread(&w->threads, &index);
+        read_binary_thread(&r->cols, r->next_binary++, r->s.name, t);
+    } else {
+        int vals[MAX_VALUES];
+        while (r->threads_left == 0) { // processes, each followed by its threads
+            int n = next_line(&r->s, vals);
+            if (n == -1) return -1;
+            if (n != 2) parse_error(&r->s, "expected process number and number of threads");
+            if (vals[0] < 0) parse_error(&r->s, "process number cannot be negative");
+            if (vals[1] < 0) parse_error(&r->s, "number of threads cannot be negative");
+            r->process_num = vals[0];
+            r->process_threads = vals[1];
+            r->threads_left = vals[1];
+        }
+        index = read_thread(&r->s, w, r->process_num, r->process_threads);
+        r->threads_left--;
+        if (r->map != NULL && r->streaming && r->s.p - (const char *)r->map >= (long)(r->released_bytes + RELEASE_STEP)) {
+            // the consumed part of the file is never looked at again
+            madvise(r->map, r->released_bytes + RELEASE_STEP, MADV_DONTNEED);
+            r->released_bytes += RELEASE_STEP;
+        }
+    }
+    Thread *t = &w->threads.arr[index];
+    if (r->streaming) {
+        if (t->original_arrival_time < r->last_arrival) {
+            char where[64] = "";
+            if (!r->binary) snprintf(where, sizeof(where), ":%ld", r->s.line_num);
+            load_error("%s%s: thread %d of process %d arrives before the thread read ahead of it; streaming needs input "
+                    "sorted by arrival time", r->s.name, where, t->thread_num, t->process_num);
+        }
+        r->last_arrival = t->original_arrival_time;
+    }
+    return index;
+}
+
+// closes the input and fills in the statistics about it; the workload's threads stay valid
+void close_workload(WorkloadReader *r, LoadStats *stats) {
+    if (stats != NULL) {
+        stats->bytes = r->data != NULL ? r->data_size : r->s.bytes_read;
+        stats->lines = r->s.line_num;
+        stats->mapped = r->map != NULL;
+        stats->binary = r->binary;
+    }
+    if (r->map != NULL && !r->binary) munmap(r->map, r->map_size);
+    free(r->s.buf);
+    if (r->s.fd >= 0 && r->s.fd != STDIN_FILENO) close(r->s.fd);
+    if (stats != NULL) stats->seconds = now_seconds() - r->start;
+    free(r);
+}
+
+// Loads the whole workload from the file at path (stdin if path is NULL), exits with a message on bad input.
+void load_workload(const char *path, Workload *w, LoadStats *stats) {
+    WorkloadReader *r = open_workload(path, w, false);
+    while (read_next_thread(r, w) != -1);
+    close_workload(r, stats);
+}
+
+// Loads the whole workload from memory (see open_workload_memory), exits with a message on bad input.
+void load_workload_memory(const void *data, size_t size, const char *name, Workload *w, LoadStats *stats) {
+    WorkloadReader *r = open_workload_memory(data, size, name, w, false);
+    while (read_next_thread(r, w) != -1);
+    close_workload(r, stats);
+}
+
+// Makes bad input on this thread return to err->jump (set with setjmp beforehand) with the reason in
+// err->message, until release_load_errors; the handler in place before is restored either way.
+void catch_load_errors(LoadError *err) {
+    err->reader = NULL;
+    err->message[0] = '\0';
+    err->outer = load_handler;
+    load_handler = err;
+}
+
+void release_load_errors(LoadError *err) {
+    load_handler = err->outer;
+}
+
+// As load_workload_memory (data given) or load_workload (data NULL, path NULL for stdin), but bad input
+// or a file that cannot be read makes it return -1 with the reason in err->message instead of exiting;
+// the workload is then left empty. Returns 0 once the workload is loaded.
+int load_workload_checked(const char *path, const void *data, size_t size, const char *name, Workload *w, LoadStats *stats,
+        LoadError *err) {
+    memset(w, 0, sizeof(Workload));
+    if (setjmp(err->jump) != 0) {
+        if (err->reader != NULL) close_workload(err->reader, NULL);
+        free_workload(w);
+        memset(w, 0, sizeof(Workload));
+        return -1;
+    }
+    catch_load_errors(err);
+    WorkloadReader *r = data != NULL ? open_workload_memory(data, size, name, w, false) : open_workload(path, w, false);
+    while (read_next_thread(r, w) != -1);
+    release_load_errors(err);
+    close_workload(r, stats);
+    return 0;
+}
+
+// frees every thread and burst of the workload at once
+void free_workload(Workload *w) {
+    free(w->threads.arr);
+    free(w->threads.free_slots);
+    memset(&w->threads, 0, sizeof(ThreadTable));
+    arena_free(&w->arena);
+    if (w->map != NULL) munmap(w->map, w->map_size);
+    w->map = NULL;
+}
@@ -0,0 +1,79 @@
+/**
+ * loader.h
+ * Reads a workload in the text input format. A regular file is memory mapped and parsed in place;
+ * anything else (stdin, a pipe) is read through a growing buffer that always holds at least one
+ * whole line, so lines of any length are accepted. Numbers are parsed by hand rather than with
+ * sscanf, and malformed input is reported with its line number.
+ * A file in the binary format (see binfmt.h) is recognised by its magic number and mapped
+ * without being parsed. An input already in memory can be read the same way.
+ *
+ * Bad input ends the program with a message, except inside load_workload_checked, which returns
+ * it instead, for callers that must outlive it (libsimcpu.c), or once catch_load_errors has set a
+ * handler to return to.
+ *
+ * Threads can be read all at once (load_workload) or one at a time through a WorkloadReader,
+ * which lets the simulator stream a long trace: a thread is only read when the simulation needs
+ * it and its slot and bursts are recycled once it terminates (release_thread).
+ */
+
+#ifndef LOADER_H
+#define LOADER_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <setjmp.h>
+#include "simcpu.h"
+#include "arena.h"
+
+typedef struct workload_struct {
+    int num_processes;
+    int units_same_switch; // switch to new thread in same process
+    int units_diff_switch; // switch to new thread in different process
+    ThreadTable threads;
+    Arena arena; // owns every burst array read from text input
+    Pool burst_pool; // recycles burst arrays of released threads when streaming
+    bool streaming;  // true if threads are read as the simulation needs them and released once they terminate
+    bool recycle;    // true if burst arrays come from burst_pool
+    void *map;   // mapping of a binary input file, which the burst arrays point into
+    size_t map_size;
+} Workload;
+
+typedef struct load_stats_struct {
+    size_t bytes;
+    long lines;
+    double seconds;
+    int mapped; // 1 if the input was memory mapped
+    int binary; // 1 if the input was in the binary format (mapped, not parsed)
+} LoadStats;
+
+typedef struct workload_reader_struct WorkloadReader;
+
+// where bad input is returned to (see catch_load_errors)
+typedef struct load_error_struct {
+    jmp_buf jump;
+    WorkloadReader *reader; // reader opened since, to close, if any
+    struct load_error_struct *outer; // handler in place before this one
+    char message[256];
+} LoadError;
+
+void load_workload(const char *path, Workload *w, LoadStats *stats);
+void load_workload_memory(const void *data, size_t size, const char *name, Workload *w, LoadStats *stats);
+WorkloadReader *open_workload(const char *path, Workload *w, bool streaming);
+WorkloadReader *open_workload_memory(const void *data, size_t size, const char *name, Workload *w, bool streaming);
+int read_next_thread(WorkloadReader *r, Workload *w);
+void close_workload(WorkloadReader *r, LoadStats *stats);
+int load_workload_checked(const char *path, const void *data, size_t size, const char *name, Workload *w, LoadStats *stats,
+        LoadError *err);
+void catch_load_errors(LoadError *err);
+void release_load_errors(LoadError *err);
+void load_error(const char *format, ...);
+void free_workload(Workload *w);
+
+void reset_thread(Thread *t);
+void reset_workload(Workload *w);
+
+Thread *add_thread(ThreadTable *threads, int *index);
+void release_thread(Workload *w, int index);
+int resident_threads(const ThreadTable *threads);
+
+#endif
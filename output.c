@@ -0,0 +1,274 @@
+/**
+ * output.c
+ * Buffered multi-format writer - see output.h
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "simcpu.h"
+#include "output.h"
+
+typedef struct name_struct {
+    const char *text;
+    int len;
+} Name;
+
+#define NAME(s) { s, sizeof(s) - 1 }
+
+static const Name states[] = {NAME(STATE_NEW), NAME(STATE_READY), NAME(STATE_RUNNING), NAME(STATE_BLOCKED),
+        NAME(STATE_TERMINATED)};
+static const char *format_names[] = {"text", "csv", "jsonl", "trace"};
+
+// "00" to "99", so the formatter writes two digits at a time
+static const char digit_pairs[201] =
+        "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+        "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+        "8081828384858687888990919293949596979899";
+
+// sets format from its name, returns 0 if there is no such format
+int parse_output_format(const char *name, OutputFormat *format) {
+    int i;
+    for (i = 0; i < NUM_FORMATS; i++) {
+        if (strcmp(name, format_names[i]) == 0) {
+            *format = (OutputFormat)i;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+const char *output_format_name(OutputFormat format) {
+    return format_names[format];
+}
+
+void output_init(OutputWriter *w, FILE *out, OutputFormat format) {
+    w->out = out;
+    w->format = format;
+    w->buf = malloc(OUTPUT_BUFFER_SIZE);
+    if (w->buf == NULL) {
+        fprintf(stderr, "malloc() failed for the output buffer.\n");
+        exit(-1);
+    }
+    w->len = 0;
+    w->started = false;
+    w->first_event = true;
+    w->records = 0;
+    w->bytes = 0;
+}
+
+static inline void put_text(OutputWriter *w, const char *text, size_t len) {
+    memcpy(w->buf + w->len, text, len);
+    w->len += len;
+}
+
+#define PUT(w, literal) put_text(w, literal, sizeof(literal) - 1)
+
+static inline void put_name(OutputWriter *w, const Name *name) {
+    put_text(w, name->text, name->len);
+}
+
+// writes the value in decimal, two digits at a time from the end
+static inline void put_int(OutputWriter *w, int value) {
+    char digits[12];
+    char *end = digits + sizeof(digits);
+    char *p = end;
+    unsigned int v = value < 0 ? 0u - (unsigned int)value : (unsigned int)value;
+    while (v >= 100) {
+        unsigned int pair = (v % 100) * 2;
+        v /= 100;
+        *--p = digit_pairs[pair + 1];
+        *--p = digit_pairs[pair];
+    }
+    if (v >= 10) {
+        *--p = digit_pairs[v * 2 + 1];
+        *--p = digit_pairs[v * 2];
+    } else {
+        *--p = (char)('0' + v);
+    }
+    if (value < 0) *--p = '-';
+    put_text(w, p, end - p);
+}
+
+// writes whatever the format needs before its first record
+static void start_output(OutputWriter *w) {
+    w->started = true;
+    if (w->format == FORMAT_CSV) PUT(w, "event,time,process,thread,from,to,arrival,service,io,turnaround,finish\n");
+    else if (w->format == FORMAT_TRACE) PUT(w, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+}
+
+// makes room for one record, writing out the buffer if it is nearly full
+static inline void start_record(OutputWriter *w) {
+    if (w->len + OUTPUT_MAX_RECORD > OUTPUT_BUFFER_SIZE) output_flush(w);
+    if (w->started == false) start_output(w);
+    w->records++;
+}
+
+// one trace event on the thread's track: ph is "B" (a slice begins), "E" (it ends) or "M" (metadata)
+static inline void put_trace_event(OutputWriter *w, const char *ph, const Name *name, int time, int process_num,
+        int thread_num) {
+    if (w->first_event == false) PUT(w, ",\n");
+    w->first_event = false;
+    PUT(w, "{\"name\": \"");
+    put_name(w, name);
+    PUT(w, "\", \"ph\": \"");
+    put_text(w, ph, 1);
+    PUT(w, "\", \"ts\": ");
+    put_int(w, time);
+    PUT(w, ", \"pid\": ");
+    put_int(w, process_num);
+    PUT(w, ", \"tid\": ");
+    put_int(w, thread_num);
+    PUT(w, "}");
+}
+
+// records a move of the given thread from state1 to state2 at the given time
+void output_transition(OutputWriter *w, int time, int process_num, int thread_num, int state1, int state2) {
+    start_record(w);
+    switch (w->format) {
+    case FORMAT_TEXT:
+        PUT(w, "At time ");
+        put_int(w, time);
+        PUT(w, ": Thread ");
+        put_int(w, thread_num);
+        PUT(w, " of Process ");
+        put_int(w, process_num);
+        PUT(w, " moves from ");
+        put_name(w, &states[state1]);
+        PUT(w, " to ");
+        put_name(w, &states[state2]);
+        PUT(w, "\n");
+        break;
+    case FORMAT_CSV:
+        PUT(w, "transition,");
+        put_int(w, time);
+        PUT(w, ",");
+        put_int(w, process_num);
+        PUT(w, ",");
+        put_int(w, thread_num);
+        PUT(w, ",");
+        put_name(w, &states[state1]);
+        PUT(w, ",");
+        put_name(w, &states[state2]);
+        PUT(w, ",,,,,\n");
+        break;
+    case FORMAT_JSONL:
+        PUT(w, "{\"event\": \"transition\", \"time\": ");
+        put_int(w, time);
+        PUT(w, ", \"process\": ");
+        put_int(w, process_num);
+        PUT(w, ", \"thread\": ");
+        put_int(w, thread_num);
+        PUT(w, ", \"from\": \"");
+        put_name(w, &states[state1]);
+        PUT(w, "\", \"to\": \"");
+        put_name(w, &states[state2]);
+        PUT(w, "\"}\n");
+        break;
+    case FORMAT_TRACE: // the thread leaves one slice and enters the next; NEW and TERMINATED have none
+        if (state1 != NEW_NUM) put_trace_event(w, "E", &states[state1], time, process_num, thread_num);
+        if (state2 != TERMINATED_NUM) put_trace_event(w, "B", &states[state2], time, process_num, thread_num);
+        break;
+    default:
+        break;
+    }
+}
+
+// records the summary of a finished thread (detailed mode)
+void output_thread(OutputWriter *w, int process_num, int thread_num, int arrival_time, int service_time, int io_time,
+        int time_finished) {
+    start_record(w);
+    switch (w->format) {
+    case FORMAT_TEXT:
+        PUT(w, "Thread ");
+        put_int(w, thread_num);
+        PUT(w, " of Process ");
+        put_int(w, process_num);
+        PUT(w, ":\n  arrival time: ");
+        put_int(w, arrival_time);
+        PUT(w, "\n  service time: ");
+        put_int(w, service_time);
+        PUT(w, " units, I/O time: ");
+        put_int(w, io_time);
+        PUT(w, " units, turnaround time: ");
+        put_int(w, time_finished - arrival_time);
+        PUT(w, " units, finish time: ");
+        put_int(w, time_finished);
+        PUT(w, " units\n");
+        break;
+    case FORMAT_CSV:
+        PUT(w, "thread,,");
+        put_int(w, process_num);
+        PUT(w, ",");
+        put_int(w, thread_num);
+        PUT(w, ",,,");
+        put_int(w, arrival_time);
+        PUT(w, ",");
+        put_int(w, service_time);
+        PUT(w, ",");
+        put_int(w, io_time);
+        PUT(w, ",");
+        put_int(w, time_finished - arrival_time);
+        PUT(w, ",");
+        put_int(w, time_finished);
+        PUT(w, "\n");
+        break;
+    case FORMAT_JSONL:
+        PUT(w, "{\"event\": \"thread\", \"process\": ");
+        put_int(w, process_num);
+        PUT(w, ", \"thread\": ");
+        put_int(w, thread_num);
+        PUT(w, ", \"arrival\": ");
+        put_int(w, arrival_time);
+        PUT(w, ", \"service\": ");
+        put_int(w, service_time);
+        PUT(w, ", \"io\": ");
+        put_int(w, io_time);
+        PUT(w, ", \"turnaround\": ");
+        put_int(w, time_finished - arrival_time);
+        PUT(w, ", \"finish\": ");
+        put_int(w, time_finished);
+        PUT(w, "}\n");
+        break;
+    case FORMAT_TRACE: // names the thread's track
+        if (w->first_event == false) PUT(w, ",\n");
+        w->first_event = false;
+        PUT(w, "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": ");
+        put_int(w, process_num);
+        PUT(w, ", \"tid\": ");
+        put_int(w, thread_num);
+        PUT(w, ", \"args\": {\"name\": \"Thread ");
+        put_int(w, thread_num);
+        PUT(w, " (service ");
+        put_int(w, service_time);
+        PUT(w, ", I/O ");
+        put_int(w, io_time);
+        PUT(w, ", turnaround ");
+        put_int(w, time_finished - arrival_time);
+        PUT(w, ")\"}}");
+        break;
+    default:
+        break;
+    }
+}
+
+// writes out everything buffered so far
+void output_flush(OutputWriter *w) {
+    if (w->len == 0) return;
+    if (fwrite(w->buf, 1, w->len, w->out) != w->len) {
+        fprintf(stderr, "ERROR: could not write the output\n");
+        exit(-1);
+    }
+    w->bytes += w->len;
+    w->len = 0;
+}
+
+// ends the output (closing the trace's JSON) and frees the buffer; the FILE is left open
+void output_finish(OutputWriter *w) {
+    if (w->format == FORMAT_TRACE) {
+        if (w->started == false) start_output(w);
+        PUT(w, "\n]}\n");
+    }
+    output_flush(w);
+    free(w->buf);
+    w->buf = NULL;
+}
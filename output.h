@@ -0,0 +1,56 @@
+/**
+ * output.h
+ * Writer for the per-event output: verbose mode's state transitions and detailed mode's thread
+ * summaries. Records are formatted straight into a large buffer with a hand-rolled integer
+ * formatter, and the buffer goes to the FILE in one write when it fills up or is flushed, so
+ * millions of records cost about as much as copying their bytes.
+ *
+ * Formats:
+ *   text   the simulator's usual lines
+ *   csv    a header, then one row per record: event,time,process,thread,from,to,arrival,service,io,turnaround,finish
+ *          (transitions fill time to "to", thread summaries the rest)
+ *   jsonl  one JSON object per record, with "event" set to "transition" or "thread"
+ *   trace  Chrome trace_event JSON (a "traceEvents" array): each state a thread is in (READY, RUNNING,
+ *          BLOCKED) is a slice on that thread's track (pid = process, tid = thread, one time unit = 1 us),
+ *          and a thread summary names its track
+ */
+
+#ifndef OUTPUT_H
+#define OUTPUT_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define OUTPUT_BUFFER_SIZE (1 << 20)
+#define OUTPUT_MAX_RECORD 512 // room a record needs in the buffer
+
+typedef enum output_format {
+    FORMAT_TEXT,
+    FORMAT_CSV,
+    FORMAT_JSONL,
+    FORMAT_TRACE,
+    NUM_FORMATS
+} OutputFormat;
+
+typedef struct output_writer_struct {
+    FILE *out;
+    OutputFormat format;
+    char *buf;
+    size_t len;
+    bool started;   // something was written (the CSV header or the start of the trace)
+    bool first_event; // trace: no event yet, so no separator before the next one
+    long records;
+    long bytes;     // written to out so far
+} OutputWriter;
+
+int parse_output_format(const char *name, OutputFormat *format);
+const char *output_format_name(OutputFormat format);
+void output_init(OutputWriter *w, FILE *out, OutputFormat format);
+void output_transition(OutputWriter *w, int time, int process_num, int thread_num, int state1, int state2);
+void output_thread(OutputWriter *w, int process_num, int thread_num, int arrival_time, int service_time, int io_time,
+        int time_finished);
+void output_flush(OutputWriter *w);
+void output_finish(OutputWriter *w);
+
+#endif
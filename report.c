@@ -0,0 +1,187 @@
+/**
+ * report.c
+ * Per-process statistics and detailed mode output - see report.h
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "report.h"
+
+#define RADIX_BITS 8
+#define RADIX_BUCKETS (1 << RADIX_BITS)
+
+void report_init(Report *r, bool keep_summaries) {
+    r->processes = NULL;
+    r->num_process_slots = 0;
+    r->num_processes = 0;
+    r->keep_summaries = keep_summaries;
+    r->summaries = NULL;
+    r->count = 0;
+    r->capacity = 0;
+    hist_init(&r->turnaround);
+    hist_init(&r->waiting);
+    hist_init(&r->response);
+}
+
+// home slot of a process number in a table of the given size (a power of two)
+static size_t process_hash(int process_num, size_t slots) {
+    return ((uint32_t)process_num * 2654435761u) & (slots - 1);
+}
+
+// returns the stats slot for the given process number, growing the table if needed
+static ProcessStats *process_slot(Report *r, int process_num) {
+    size_t i;
+    if (process_num < 0) {
+        fprintf(stderr, "ERROR: Invalid process number %d in input\n", process_num);
+        exit(-1);
+    }
+    if (2 * (r->num_processes + 1) > r->num_process_slots) { // keep the table at most half full
+        size_t slots = r->num_process_slots > 0 ? r->num_process_slots * 2 : 16;
+        if (slots < r->num_process_slots || slots > SIZE_MAX / sizeof(ProcessStats)) {
+            fprintf(stderr, "ERROR: too many processes for the process table\n");
+            exit(-1);
+        }
+        ProcessStats *grown = calloc(slots, sizeof(ProcessStats));
+        if (grown == NULL) {
+            fprintf(stderr, "calloc() failed for growing the process table.\n");
+            exit(-1);
+        }
+        for (i = 0; i < r->num_process_slots; i++) {
+            const ProcessStats *p = &r->processes[i];
+            if (p->threads_finished == 0) continue;
+            size_t j = process_hash(p->process_num, slots);
+            while (grown[j].threads_finished > 0) j = (j + 1) & (slots - 1);
+            grown[j] = *p;
+        }
+        free(r->processes);
+        r->processes = grown;
+        r->num_process_slots = slots;
+    }
+    i = process_hash(process_num, r->num_process_slots);
+    while (r->processes[i].threads_finished > 0 && r->processes[i].process_num != process_num) {
+        i = (i + 1) & (r->num_process_slots - 1);
+    }
+    if (r->processes[i].threads_finished == 0) {
+        r->processes[i].process_num = process_num;
+        r->num_processes++;
+    }
+    return &r->processes[i];
+}
+
+// records a terminated thread; the Thread is not referenced afterwards and can be released
+void report_thread_finished(Report *r, const Thread *t) {
+    ProcessStats *p = process_slot(r, t->process_num);
+    if (p->threads_finished == 0 || t->original_arrival_time < p->first_arrival) {
+        p->first_arrival = t->original_arrival_time;
+    }
+    if (p->threads_finished == 0 || t->time_finished > p->last_finish) {
+        p->last_finish = t->time_finished;
+    }
+    p->service_time += t->service_time;
+    p->io_time += t->io_time;
+    p->threads_finished++;
+    int turnaround = t->time_finished - t->original_arrival_time;
+    hist_add(&r->turnaround, turnaround);
+    hist_add(&r->waiting, turnaround - t->service_time - t->io_time);
+    hist_add(&r->response, t->time_first_enters_cpu - t->original_arrival_time);
+
+    if (r->keep_summaries == false) return;
+    if (r->count == r->capacity) {
+        int capacity = r->capacity > 0 ? r->capacity * 2 : 1024;
+        ThreadSummary *grown = realloc(r->summaries, capacity * sizeof(ThreadSummary));
+        if (grown == NULL) {
+            fprintf(stderr, "realloc() failed for growing the thread summaries.\n");
+            exit(-1);
+        }
+        r->summaries = grown;
+        r->capacity = capacity;
+    }
+    ThreadSummary *s = &r->summaries[r->count++];
+    s->process_num = t->process_num;
+    s->thread_num = t->thread_num;
+    s->arrival_time = t->original_arrival_time;
+    s->service_time = t->service_time;
+    s->io_time = t->io_time;
+    s->time_finished = t->time_finished;
+}
+
+// sum over all processes of (last thread finish - first thread arrival)
+long report_turnaround_total(const Report *r) {
+    long total = 0;
+    size_t i;
+    for (i = 0; i < r->num_process_slots; i++) {
+        if (r->processes[i].threads_finished > 0) {
+            total += r->processes[i].last_finish - r->processes[i].first_arrival;
+        }
+    }
+    return total;
+}
+
+static uint64_t summary_key(const ThreadSummary *s) {
+    // flip the sign bits so negative numbers order before positive ones
+    return ((uint64_t)((uint32_t)s->process_num ^ 0x80000000u) << 32) | ((uint32_t)s->thread_num ^ 0x80000000u);
+}
+
+// stable LSD radix sort of the summaries by (process number, thread number), one byte per pass;
+// passes where every key has the same byte are skipped
+static void sort_summaries(Report *r) {
+    int n = r->count;
+    int pass, i;
+    if (n < 2) return;
+    ThreadSummary *buffer = malloc(n * sizeof(ThreadSummary));
+    if (buffer == NULL) {
+        fprintf(stderr, "malloc() failed for sorting the thread summaries.\n");
+        exit(-1);
+    }
+    ThreadSummary *src = r->summaries;
+    ThreadSummary *dst = buffer;
+    for (pass = 0; pass < 64 / RADIX_BITS; pass++) {
+        int shift = pass * RADIX_BITS;
+        int counts[RADIX_BUCKETS] = {0};
+        for (i = 0; i < n; i++) counts[(summary_key(&src[i]) >> shift) & (RADIX_BUCKETS - 1)]++;
+        if (counts[(summary_key(&src[0]) >> shift) & (RADIX_BUCKETS - 1)] == n) continue; // nothing to do
+
+        int offset = 0;
+        for (i = 0; i < RADIX_BUCKETS; i++) { // turn counts into starting offsets
+            int c = counts[i];
+            counts[i] = offset;
+            offset += c;
+        }
+        for (i = 0; i < n; i++) dst[counts[(summary_key(&src[i]) >> shift) & (RADIX_BUCKETS - 1)]++] = src[i];
+        ThreadSummary *temp = src;
+        src = dst;
+        dst = temp;
+    }
+    if (src != r->summaries) memcpy(r->summaries, src, n * sizeof(ThreadSummary));
+    free(buffer);
+}
+
+// prints the information of every finished thread, ordered by process number then thread number
+void report_print_details(Report *r, OutputWriter *out) {
+    int i;
+    sort_summaries(r);
+    for (i = 0; i < r->count; i++) {
+        const ThreadSummary *s = &r->summaries[i];
+        output_thread(out, s->process_num, s->thread_num, s->arrival_time, s->service_time, s->io_time, s->time_finished);
+    }
+    output_flush(out);
+}
+
+static void print_percentiles(const char *name, const Histogram *h, FILE *out) {
+    fprintf(out, "%s Time percentiles: p50 %d, p90 %d, p99 %d, p99.9 %d units\n", name, hist_percentile(h, 50),
+            hist_percentile(h, 90), hist_percentile(h, 99), hist_percentile(h, 99.9));
+}
+
+// prints the percentiles of the threads' turnaround, waiting and response times
+void report_print_latency(const Report *r, FILE *out) {
+    print_percentiles("Thread Turnaround", &r->turnaround, out);
+    print_percentiles("Thread Waiting", &r->waiting, out);
+    print_percentiles("Thread Response", &r->response, out);
+}
+
+void report_free(Report *r) {
+    free(r->processes);
+    free(r->summaries);
+    report_init(r, r->keep_summaries);
+}
@@ -0,0 +1,59 @@
+/**
+ * report.h
+ * Statistics gathered as threads terminate. Per-process totals are kept in a hash table keyed by
+ * process number (open addressing), so the turnaround time needs no sorting and any process number
+ * costs the same. For detailed mode, a small summary
+ * of each finished thread is kept (not the Thread itself) and radix sorted by
+ * (process number, thread number) before printing.
+ * The turnaround, waiting and response times of the threads also go into histograms (see hist.h),
+ * so their percentiles are known at any thread count without keeping the threads.
+ */
+
+#ifndef REPORT_H
+#define REPORT_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include "simcpu.h"
+#include "hist.h"
+#include "output.h"
+
+typedef struct process_stats_struct {
+    int process_num;
+    int first_arrival; // lowest original arrival time of any of its threads
+    int last_finish;   // highest finish time of any of its threads
+    long service_time;
+    long io_time;
+    int threads_finished; // 0 if no thread of this process has terminated (the slot is free)
+} ProcessStats;
+
+typedef struct thread_summary_struct {
+    int process_num;
+    int thread_num;
+    int arrival_time;
+    int service_time;
+    int io_time;
+    int time_finished;
+} ThreadSummary;
+
+typedef struct report_struct {
+    ProcessStats *processes; // hash table keyed by process number, at most half full
+    size_t num_process_slots; // a power of two, or 0
+    size_t num_processes;     // slots in use
+    bool keep_summaries; // only needed for detailed mode
+    ThreadSummary *summaries;
+    int count;
+    int capacity;
+    Histogram turnaround; // per thread: finish - arrival
+    Histogram waiting;    // turnaround less service and I/O time (ready, or being switched in)
+    Histogram response;   // first time on the CPU - arrival
+} Report;
+
+void report_init(Report *r, bool keep_summaries);
+void report_thread_finished(Report *r, const Thread *t);
+long report_turnaround_total(const Report *r);
+void report_print_details(Report *r, OutputWriter *out);
+void report_print_latency(const Report *r, FILE *out);
+void report_free(Report *r);
+
+#endif
@@ -0,0 +1,337 @@
+/**
+ * sample.c
+ * Sampled simulation implementation - see sample.h
+ *
+ * SOURCES:
+ * - R. Wunderlich, T. Wenisch, B. Falsafi and J. Hoe, "SMARTS: Accelerating Microarchitecture
+ *   Simulation via Rigorous Statistical Sampling", ISCA 2003 (systematic sampling with warm-up)
+ * - W. Cochran, "Sampling Techniques", 3rd ed., Wiley, 1977, chapter 6 (ratio estimates and their variance)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "sample.h"
+#include "report.h"
+
+#define SAMPLE_SEED 2463534242u
+#define SAMPLE_MAX_SIMULATED 0.5 // share of the CPU time past which the whole workload is simulated instead
+
+// Student's t for a 95% interval with 1 to 30 degrees of freedom; the normal 1.96 beyond
+static const double t_975[] = {12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228, 2.201, 2.179,
+        2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086, 2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048,
+        2.045, 2.042};
+
+typedef struct thread_ref_struct {
+    int process_num;
+    int index; // in the workload's thread table
+} ThreadRef;
+
+// the threads of one process, which are next to each other in the thread order
+typedef struct process_span_struct {
+    int process_num;
+    int first;        // in the thread order
+    int num_threads;
+    int first_arrival;
+    long cpu;         // CPU time of all its threads
+} ProcessSpan;
+
+// what the simulation of one sampled window gave
+typedef struct window_sample_struct {
+    double cpu;        // CPU time of the segment simulated (the window and its neighbours)
+    double overhead;   // time it took beyond its CPU time
+    double processes;  // processes of the window itself
+    double turnaround; // their total turnaround time
+    double start_cpu;  // CPU time of every window before the segment
+    double ratio_used; // overhead per unit of CPU time the segment's clock started with
+} WindowSample;
+
+static int compare_thread_refs(const void *a, const void *b) {
+    const ThreadRef *x = a, *y = b;
+    if (x->process_num != y->process_num) return x->process_num < y->process_num ? -1 : 1;
+    return x->index < y->index ? -1 : x->index > y->index;
+}
+
+static int compare_process_spans(const void *a, const void *b) {
+    const ProcessSpan *x = a, *y = b;
+    if (x->first_arrival != y->first_arrival) return x->first_arrival < y->first_arrival ? -1 : 1;
+    return x->process_num < y->process_num ? -1 : x->process_num > y->process_num;
+}
+
+static void *sample_alloc(size_t size, const char *what) {
+    void *p = malloc(size > 0 ? size : 1);
+    if (p == NULL) {
+        fprintf(stderr, "malloc() failed for %s.\n", what);
+        exit(-1);
+    }
+    return p;
+}
+
+// half width of the 95% interval of the ratio estimate sum(num) / sum(den) over n samples
+static double ratio_error(const WindowSample *samples, int n, double ratio, bool turnaround) {
+    double residuals = 0;
+    double den_total = 0;
+    int i;
+    for (i = 0; i < n; i++) {
+        double num = turnaround ? samples[i].turnaround : samples[i].overhead;
+        double den = turnaround ? samples[i].processes : samples[i].cpu;
+        residuals += (num - ratio * den) * (num - ratio * den);
+        den_total += den;
+    }
+    if (den_total <= 0) return 0;
+    double t = n - 1 <= 30 ? t_975[n - 2] : 1.96;
+    return t * sqrt(residuals / (n - 1) / n) / (den_total / n);
+}
+
+// the workload's processes in order of first arrival, split into windows
+typedef struct partition_struct {
+    const Workload *w;
+    ThreadRef *order;     // threads by process
+    ProcessSpan *spans;   // processes by first arrival
+    int num_spans;
+    int num_windows;
+    int *window_start;    // first process of each window, and num_spans after the last
+    double *cpu_before;   // CPU time of every window before each
+} Partition;
+
+// Simulates windows first to last from the state the full run is estimated to reach by then, and
+// measures the processes of the given window in s. Returns the time that window's last thread finished.
+static int simulate_segment(const Partition *p, const SimConfig *cfg, int first, int window, int last, WindowSample *s) {
+    Workload segment;
+    int i, j, index;
+    int measured = 0; // index of the window's first thread in the segment
+    memset(&segment, 0, sizeof(Workload));
+    arena_init(&segment.arena);
+    pool_init(&segment.burst_pool);
+    segment.num_processes = p->window_start[last + 1] - p->window_start[first];
+    segment.units_same_switch = p->w->units_same_switch;
+    segment.units_diff_switch = p->w->units_diff_switch;
+    for (i = p->window_start[first]; i < p->window_start[last + 1]; i++) {
+        if (i == p->window_start[window]) measured = segment.threads.count;
+        for (j = 0; j < p->spans[i].num_threads; j++) {
+            Thread *t = add_thread(&segment.threads, &index);
+            *t = p->w->threads.arr[p->order[p->spans[i].first + j].index];
+            reset_thread(t);
+        }
+    }
+
+    SimState resume;
+    SimConfig config = *cfg;
+    SimResult sim;
+    Report report;
+    memset(&resume, 0, sizeof(SimState));
+    resume.time_total = (int)(s->start_cpu * (1 + s->ratio_used) + 0.5);
+    config.verbose = false;
+    config.detailed = false;
+    config.count = false;
+    config.on_pause = NULL;
+    config.resume = &resume;
+    report_init(&report, false);
+    if (run_simulation(&segment, NULL, &config, &report, &sim) != 0) {
+        fprintf(stderr, "ERROR: %s\n", sim.error);
+        exit(-1);
+    }
+    s->cpu = sim.cpu_time_total;
+    s->overhead = (double)sim.time_total - resume.time_total - sim.cpu_time_total;
+
+    int window_finish = 0;
+    s->processes = p->window_start[window + 1] - p->window_start[window];
+    s->turnaround = 0;
+    for (i = p->window_start[window]; i < p->window_start[window + 1]; i++) {
+        int last_finish = 0;
+        for (j = 0; j < p->spans[i].num_threads; j++) {
+            const Thread *t = &segment.threads.arr[measured++];
+            if (j == 0 || t->time_finished > last_finish) last_finish = t->time_finished;
+        }
+        s->turnaround += last_finish - p->spans[i].first_arrival;
+        if (last_finish > window_finish) window_finish = last_finish;
+    }
+    report_free(&report);
+    free_sim_result(&sim);
+    free_workload(&segment);
+    return window_finish;
+}
+
+// simulates the whole workload under cfg on a copy of its threads, giving exact results in place of estimates
+static void run_exact(const Workload *w, const SimConfig *cfg, SampleResult *res) {
+    Workload copy = *w; // shares the bursts; the simulation only reads them
+    SimConfig config = *cfg;
+    SimResult sim;
+    Report report;
+    int i;
+    copy.streaming = false;
+    copy.threads.arr = sample_alloc(w->threads.count * sizeof(Thread), "the threads of an exact run");
+    memcpy(copy.threads.arr, w->threads.arr, w->threads.count * sizeof(Thread));
+    for (i = 0; i < copy.threads.count; i++) reset_thread(&copy.threads.arr[i]);
+    config.verbose = false;
+    config.detailed = false;
+    config.count = false;
+    config.on_pause = NULL;
+    config.resume = NULL;
+    report_init(&report, false);
+    if (run_simulation(&copy, NULL, &config, &report, &sim) != 0) {
+        fprintf(stderr, "ERROR: %s\n", sim.error);
+        exit(-1);
+    }
+    res->exact = true;
+    res->cpu_time_simulated += sim.cpu_time_total;
+    res->time_total.value = sim.time_total;
+    res->average_turnaround.value = (double)report_turnaround_total(&report) / w->num_processes;
+    res->cpu_utilization.value = sim.time_total > 0 ? 100 * (double)sim.cpu_time_total / sim.time_total : 0.0;
+    res->time_total.error = 0;
+    res->average_turnaround.error = 0;
+    res->cpu_utilization.error = 0;
+    report_free(&report);
+    free_sim_result(&sim);
+    free(copy.threads.arr);
+}
+
+// Estimates the results of simulating the whole workload under cfg (on one core) from the sampled
+// windows, or gives the exact results if sampling would be biased or not much faster (see sample.h).
+// The workload is only read: each window is simulated on copies of its threads.
+void run_sampled(const Workload *w, const SimConfig *cfg, const SampleSpec *spec, SampleResult *res) {
+    int num_threads = w->threads.count;
+    int i, j, k;
+    memset(res, 0, sizeof(SampleResult));
+    if (cfg->cores > 1) {
+        fprintf(stderr, "ERROR: a sampled simulation can only run on one core\n");
+        exit(-1);
+    }
+
+    // threads by process, then the processes by first arrival
+    ThreadRef *order = sample_alloc(num_threads * sizeof(ThreadRef), "the thread order");
+    int num_refs = 0;
+    for (i = 0; i < num_threads; i++) {
+        if (w->threads.arr[i].cpu_burst_times == NULL) continue; // released slot
+        order[num_refs].process_num = w->threads.arr[i].process_num;
+        order[num_refs++].index = i;
+    }
+    qsort(order, num_refs, sizeof(ThreadRef), compare_thread_refs);
+    ProcessSpan *spans = sample_alloc(num_refs * sizeof(ProcessSpan), "the process list");
+    int num_spans = 0;
+    for (i = 0; i < num_refs; i++) {
+        const Thread *t = &w->threads.arr[order[i].index];
+        if (num_spans == 0 || spans[num_spans - 1].process_num != t->process_num) {
+            ProcessSpan *span = &spans[num_spans++];
+            span->process_num = t->process_num;
+            span->first = i;
+            span->num_threads = 0;
+            span->first_arrival = t->original_arrival_time;
+            span->cpu = 0;
+        }
+        ProcessSpan *span = &spans[num_spans - 1];
+        span->num_threads++;
+        if (t->original_arrival_time < span->first_arrival) span->first_arrival = t->original_arrival_time;
+        span->cpu += t->service_time;
+        res->cpu_time_total += t->service_time;
+    }
+    qsort(spans, num_spans, sizeof(ProcessSpan), compare_process_spans);
+
+    // windows of equal numbers of processes, and the CPU time before each
+    int num_windows = spec->windows < num_spans ? spec->windows : num_spans;
+    if (num_windows < 2) {
+        fprintf(stderr, "ERROR: a sampled simulation needs at least 2 processes, not %d\n", num_spans);
+        exit(-1);
+    }
+    int *window_start = sample_alloc((num_windows + 1) * sizeof(int), "the windows");
+    double *cpu_before = sample_alloc((num_windows + 1) * sizeof(double), "the windows");
+    cpu_before[0] = 0;
+    for (j = 0; j <= num_windows; j++) {
+        window_start[j] = (int)((long)j * num_spans / num_windows);
+        if (j == 0) continue;
+        cpu_before[j] = cpu_before[j - 1];
+        for (i = window_start[j - 1]; i < window_start[j]; i++) cpu_before[j] += spans[i].cpu;
+    }
+    Partition p = {w, order, spans, num_spans, num_windows, window_start, cpu_before};
+
+    // every step-th window from a pseudo-random start
+    int num_samples = (int)(spec->rate * num_windows + 0.5);
+    if (num_samples < 2) num_samples = 2;
+    if (num_samples > num_windows) num_samples = num_windows;
+    double step = (double)num_windows / num_samples;
+    unsigned int state = SAMPLE_SEED;
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    double start = step * (state / 4294967296.0);
+    WindowSample *samples = sample_alloc(num_samples * sizeof(WindowSample), "the samples");
+    double overhead_total = 0;
+    double cpu_total = 0;
+    int max_after = step / 4 > 1 ? (int)(step / 4) : 1; // windows simulated after a sampled one
+
+    res->windows = num_windows;
+    for (k = 0; k < num_samples; k++) {
+        int window = (int)(start + k * step);
+        int first = window > 0 ? window - 1 : 0;
+        int last = window < num_windows - 1 ? window + 1 : num_windows - 1;
+        WindowSample *s = &samples[k];
+        s->ratio_used = cpu_total > 0 ? overhead_total / cpu_total : 0;
+        s->start_cpu = cpu_before[first];
+        // grown until nothing after it arrives before its window is done (as that would have run
+        // first), twice as far after the window each time, up to a quarter of the way to the next sample
+        for (;;) {
+            int window_finish = simulate_segment(&p, cfg, first, window, last, s);
+            res->cpu_time_simulated += s->cpu;
+            if (last == num_windows - 1 || window_finish <= p.spans[p.window_start[last + 1]].first_arrival) break;
+            if (last - window >= max_after) {
+                res->windows_truncated++;
+                break;
+            }
+            last = window + 2 * (last - window);
+            if (last - window > max_after) last = window + max_after;
+            if (last > num_windows - 1) last = num_windows - 1;
+        }
+        overhead_total += s->overhead;
+        cpu_total += s->cpu;
+        res->windows_sampled = k + 1;
+        // a window cut short biases the estimates beyond their intervals, and a sample heading for
+        // more than SAMPLE_MAX_SIMULATED of the CPU time saves little over the full run
+        if (res->windows_truncated > 0
+                || res->cpu_time_simulated * (double)num_samples / (k + 1) > SAMPLE_MAX_SIMULATED * res->cpu_time_total) {
+            run_exact(w, cfg, res);
+            break;
+        }
+    }
+    if (res->exact) {
+        free(order);
+        free(spans);
+        free(window_start);
+        free(cpu_before);
+        free(samples);
+        return;
+    }
+
+    // the turnaround times as if every segment's clock had started from the final estimate
+    double ratio = cpu_total > 0 ? overhead_total / cpu_total : 0;
+    double turnaround_total = 0;
+    double processes_total = 0;
+    for (k = 0; k < num_samples; k++) {
+        samples[k].turnaround += samples[k].processes * (ratio - samples[k].ratio_used) * samples[k].start_cpu;
+        turnaround_total += samples[k].turnaround;
+        processes_total += samples[k].processes;
+    }
+    double ratio_err = ratio_error(samples, num_samples, ratio, false);
+    // every process's finish moves with the overhead before its segment, so the error of the overhead
+    // ratio adds that of the average CPU time before a segment to the turnaround time's
+    double start_cpu_average = 0;
+    for (j = 0; j < num_windows; j++) {
+        start_cpu_average += (window_start[j + 1] - window_start[j]) * cpu_before[j > 0 ? j - 1 : 0] / num_spans;
+    }
+    double turnaround_err = ratio_error(samples, num_samples, turnaround_total / processes_total, true);
+    double clock_err = ratio_err * start_cpu_average;
+    double low = ratio - ratio_err > 0 ? ratio - ratio_err : 0;
+
+    res->time_total.value = res->cpu_time_total * (1 + ratio);
+    res->time_total.error = res->cpu_time_total * ratio_err;
+    res->average_turnaround.value = turnaround_total / processes_total;
+    res->average_turnaround.error = sqrt(turnaround_err * turnaround_err + clock_err * clock_err);
+    res->cpu_utilization.value = 100 / (1 + ratio);
+    res->cpu_utilization.error = (100 / (1 + low) - 100 / (1 + ratio + ratio_err)) / 2;
+
+    free(order);
+    free(spans);
+    free(window_start);
+    free(cpu_before);
+    free(samples);
+}
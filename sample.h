@@ -0,0 +1,65 @@
+/**
+ * sample.h
+ * Sampled simulation: estimates the headline results of a long trace (total time, average
+ * turnaround time and CPU utilization) from exact simulations of a few parts of it, with 95%
+ * confidence intervals, in a fraction of the time of a full run.
+ *
+ * The processes are ordered by their first arrival and split into windows of equal size, and a
+ * systematic sample of the windows (every 1/rate-th, from a fixed pseudo-random start) is simulated.
+ * Each sampled window is simulated together with the window before it, which warms up the queues
+ * and the last thread on the CPU, and the window after it, which competes with it for the CPU as it
+ * would in the full run; only the processes of the window itself are measured. The clock starts at
+ * an estimate of the time the full run would have reached, as the CPU time of every earlier window
+ * (known exactly from the input) plus the overhead (context switches and I/O waits) estimated so far.
+ *
+ * The total CPU time is exact; the overhead per unit of CPU time, and so the total time and the
+ * utilization, and the mean turnaround time per process are ratio estimates over the sampled
+ * windows, with intervals from the spread between them (Student's t). As the clock never waits for
+ * an arrival, a turnaround time is the time of the whole run so far minus an arrival time, so the
+ * error of the overhead ratio carries over to it, times the CPU time before the average window.
+ *
+ * When the run falls behind the arrivals, a thread's later bursts wait for the first bursts of every
+ * thread arriving before they are ready, which can be well past the next window. The segment is then
+ * grown (doubling) until nothing after it arrives before the sampled window's threads are done, but
+ * only up to a quarter of the way to the next sampled window. A window cut short there would bias
+ * the estimates (its turnaround times too low) by more than the intervals, which only cover the
+ * sampling error, and a sample whose segments add up to more than half the CPU time would save
+ * little over a full run: in either case sampling stops and the whole workload is simulated
+ * instead, giving exact results with intervals of zero width (bench/sample_bench.c measures the
+ * estimates against exact runs, and how often this happens).
+ */
+
+#ifndef SAMPLE_H
+#define SAMPLE_H
+
+#include "engine.h"
+#include "loader.h"
+
+#define SAMPLE_DEFAULT_WINDOWS 1000
+
+typedef struct sample_spec_struct {
+    double rate; // fraction of the windows to sample, between 0 and 1
+    int windows; // windows the processes are split into (fewer if there are fewer processes)
+} SampleSpec;
+
+// an estimate and the half width of its 95% confidence interval
+typedef struct estimate_struct {
+    double value;
+    double error;
+} Estimate;
+
+typedef struct sample_result_struct {
+    int windows;
+    int windows_sampled;      // before sampling stopped, if it did
+    int windows_truncated;    // sampled windows whose segment could not be grown far enough (see above)
+    bool exact;               // sampling stopped and the whole workload was simulated instead (see above)
+    long cpu_time_total;      // of the whole workload (exact)
+    long cpu_time_simulated;  // of every segment simulated, grown ones counted again, and of the full run
+    Estimate time_total;
+    Estimate average_turnaround;
+    Estimate cpu_utilization; // percent
+} SampleResult;
+
+void run_sampled(const Workload *w, const SimConfig *cfg, const SampleSpec *spec, SampleResult *res);
+
+#endif
@@ -3,15 +3,41 @@
  * 2021-02-22
  * CIS*3110 Assignment 2
  * A CPU Scheduler simulation that takes input from a given file,
- * having the following usage: "./simcpu [-d] [-v] [-r quantum] < input_file"
+ * having the following usage: "./simcpu [-d] [-v] [-r quantum] [-p policy] [-s] [input_file | < input_file]"
  * - where the d flag is for detailed information
  * - where the v flag is for verbose mode
  * - where the r flag indicates round robin scheduling with the given quantum
+ * - where the p flag selects the scheduling policy: fcfs, rr, sjf, srtf, priority or mlfq (see engine.h);
+ *   the r flag's quantum is also the base quantum of mlfq
+ * - where the --cores flag simulates that many CPUs, each with its own run queue, optionally with a
+ *   --migration-cost for a thread moving between them (see engine.h)
+ * - where the --format flag writes verbose and detailed output as text (the default), csv, jsonl or a
+ *   Chrome trace (which turns verbose mode on), to the --output file if one is given (see output.h)
+ * - where the --latency flag prints percentiles of the threads' turnaround, waiting and response times
+ *   after the average turnaround time (see report.h)
+ * - where the s flag prints statistics about the run (input parsing speed, time spent in each phase and
+ *   counters kept by the simulation loop), and --stats-json writes them to a file as JSON (see stats.h)
+ * - where the --stream flag reads threads only as the simulation reaches their arrival time
+ *   (the input must be sorted by arrival time), optionally capped by --max-resident count
+ * - where the --checkpoint flag saves the simulation's state at the given time to a file, and the
+ *   --resume flag carries on from such a file (with the same input, under any policy) instead of
+ *   simulating from the start (see checkpoint.h)
+ * With --sweep, it simulates the workload under every combination of the given --policies, --quanta
+ * and --switch-costs lists on a pool of --jobs threads (one per CPU by default), printing a CSV row each,
+ * optionally all from the point saved in a --resume file.
+ * With --sample, it estimates the total time, average turnaround time and CPU utilization of a long trace
+ * from exact simulations of a fraction (the sampling rate) of its --windows, with 95% confidence intervals,
+ * or simulates it in full when a sample would be biased or not much faster (see sample.h).
+ * With --batch, it simulates each of the given input files (many small workloads) under the one policy,
+ * printing a CSV row each; FCFS and RR workloads on one core are run side by side in lockstep (see batch.h).
+ * It can also convert a text input file to the binary workload format (see binfmt.h) with
+ * "./simcpu --convert output_file [input_file | < input_file]"; binary files are loaded the same way as text.
+ * A single run is made through the embedding interface (see libsimcpu.h), like any other program's.
  * The input file format is specified in the Assignment 2 Description, and only that format
  * is supported with this program.
  * 
  * SOURCES:
- * - Code for Heap inspired by https://gist.github.com/sudhanshuptl/d86da25da46aa3d060e7be876bbdb343
+ * - Code for Heap (now heap.c) inspired by https://gist.github.com/sudhanshuptl/d86da25da46aa3d060e7be876bbdb343
  * 
  */
 
@@ -19,519 +45,465 @@
 #include <stdlib.h>
 #include <stdbool.h>
 #include <string.h>
+#include <assert.h>
+#include "simcpu.h"
+#include "loader.h"
+#include "binfmt.h"
+#include "engine.h"
+#include "sweep.h"
+#include "checkpoint.h"
+#include "batch.h"
+#include "sample.h"
+#include "libsimcpu.h"
 
 #define SUCCESS 1
 #define FAILURE 0
-#define MAX_LEN 500
-#define MAX_CAPACITY 1000
-
-#define STATE_NEW "NEW"
-#define STATE_READY "READY"
-#define STATE_RUNNING "RUNNING"
-#define STATE_BLOCKED "BLOCKED"
-#define STATE_TERMINATED "TERMINATED"
-
-#define NEW_NUM 0
-#define READY_NUM 1
-#define RUNNING_NUM 2
-#define BLOCKED_NUM 3
-#define TERMINATED_NUM 4
+#define USAGE "Usage: ./simcpu [-d] [-v] [-r quantum] [-p fcfs|rr|sjf|srtf|priority|mlfq] [--latency] [-s] [--stats-json file]\n" \
+        "                [--format text|csv|jsonl|trace] [--output file]\n" \
+        "                [--cores count [--migration-cost units]] [--stream [--max-resident count]]\n" \
+        "                [--checkpoint time file | --resume file] [input_file | < input_file]\n" \
+        "       ./simcpu --sample rate [--windows count] [-r quantum] [-p policy] [input_file | < input_file]\n" \
+        "       ./simcpu --sweep [--policies list] [--quanta list] [--switch-costs same:diff,...] [--jobs count] [--resume file]\n" \
+        "                [-r quantum] [-p policy] [--cores count [--migration-cost units]] [input_file | < input_file]\n" \
+        "       ./simcpu --batch [-r quantum] [-p policy] [--cores count [--migration-cost units]] input_file...\n" \
+        "       ./simcpu --convert output_file [input_file | < input_file]\n"
 
 /* --------------------------------- PROTOTYPES ---------------------------------*/
 
-typedef struct thread_struct {
-    int thread_num;
-    int num_threads;
-    int arrival_time;
-    int burst_num;
-    int process_num;
-    int original_arrival_time;
-    int time_finished;
-    int current_burst;
-    int time_enters_cpu;
-    int service_time;
-    int io_time;
-    int *cpu_burst_times;
-    int *io_burst_times;
-} Thread;
-
-typedef struct verbose_struct {
-    int time;
-    int thread_num;
-    int process_num;
-    int state1;
-    int state2;
-} VerboseLine;
-
-typedef struct heap_struct {
-    Thread **arr;
-    int count;
-    int capacity;
-} PriorityQueue;
-
-int get_data(PriorityQueue *pq);
-int set_flags(bool* d, bool *v, bool *r, int argc, char *argv[]);
-
-PriorityQueue *CreateHeap(int capacity);
-void insert(PriorityQueue *h, Thread *key);
-void print(PriorityQueue *h);
-void up_heap(PriorityQueue *h,int index);
-void down_heap(PriorityQueue *h, int parent_node);
-Thread* PopMin(PriorityQueue *h);
-void free_thread(Thread *t);
+typedef struct options_struct {
+    bool d_flag;
+    bool v_flag;
+    bool r_flag;
+    bool p_flag;
+    PolicyKind policy;
+    OutputFormat format;     // of the verbose and detailed output
+    const char *output_path; // write the verbose and detailed output here (NULL for standard output)
+    bool latency;     // print the percentiles of the threads' times
+    bool s_flag;
+    const char *stats_json_path; // write the statistics here as JSON ("-" for standard output)
+    int quantum;
+    const char *input_path; // NULL to read stdin
+    const char *convert_path; // write the input in binary format here instead of simulating
+    bool stream;      // read threads as the simulation reaches them instead of all up front
+    int max_resident; // when streaming, fail if more threads than this are held at once (0 = no limit)
+    int cores;          // simulated CPUs
+    int migration_cost; // extra switch time when a thread moves to another core
+    int checkpoint_time;         // save the simulation's state at this time...
+    const char *checkpoint_path; // ...to this file (NULL for none)
+    const char *resume_path;     // carry on from the state saved in this file (NULL to start from the beginning)
+    bool sweep;         // print a CSV row for each combination of sweep_spec's lists instead
+    SweepSpec sweep_spec;
+    SampleSpec sample_spec; // estimate the results from this fraction of the windows (rate 0 to simulate it all)
+    bool batch;         // print a CSV row for each of the input files instead
+    const char **inputs; // every input file given, for a batch
+    int num_inputs;
+} Options;
+
+int set_flags(Options *opts, int argc, char *argv[]);
+int set_sweep_flags(Options *opts);
+int set_batch_flags(Options *opts);
+void exit_with_error(const SimcpuContext *ctx);
+void print_percentiles(const char *name, const SimcpuTimes *times);
+void simulate_batch(const Options *opts);
+void simulate_sampled(const Options *opts);
 
 /* --------------------------------------- MAIN --------------------------------------- */
 int main (int argc, char *argv[]) {
-    char *states[] = {STATE_NEW, STATE_READY, STATE_RUNNING, STATE_BLOCKED, STATE_TERMINATED};
-    if (argc > 5) { // invalid number of arguments
-        fprintf(stderr, "Usage: ./simcpu [-d] [-v] [-r quantum] < input_file\n");
+    Options opts;
+    int i;
+    if (set_flags(&opts, argc, argv) == FAILURE) {
+        fprintf(stderr, USAGE);
         exit(-1);
     }
 
-    bool d_flag = false;
-    bool v_flag = false;
-    bool r_flag = false;
-    int quantum = -1;
-    char line[MAX_LEN];
-    int i, j;
-    int total_num_threads;
-
-    PriorityQueue *pq = CreateHeap(MAX_CAPACITY);
+    if (opts.convert_path != NULL) {
+        Workload workload;
+        load_workload(opts.input_path, &workload, NULL);
+        write_binary_workload(&workload, opts.convert_path);
+        free_workload(&workload);
+        return 0;
+    }
 
-    if (argc > 1) {
-        quantum = set_flags(&d_flag, &v_flag, &r_flag, argc, argv);
-        if (r_flag && quantum <= 0) {
-            fprintf(stderr, "Usage: ./simcpu [-d] [-v] [-r quantum] < input_file\n");
-            exit(-1);
+    if (opts.sweep == true) {
+        Workload workload;
+        SwitchCost workload_cost;
+        SimState resume;
+        load_workload(opts.input_path, &workload, NULL);
+        if (workload.num_processes <= 0) return 0;
+        if (opts.resume_path != NULL) {
+            read_checkpoint(opts.resume_path, &workload, &resume);
+            opts.sweep_spec.resume = &resume;
         }
+        if (opts.sweep_spec.num_switch_costs == 0) { // default to the costs given in the input
+            workload_cost.same = workload.units_same_switch;
+            workload_cost.diff = workload.units_diff_switch;
+            opts.sweep_spec.switch_costs = &workload_cost;
+            opts.sweep_spec.num_switch_costs = 1;
+        }
+        run_sweep(&workload, &opts.sweep_spec, stdout);
+        free_workload(&workload);
+        return 0;
     }
 
-    if (r_flag == true) {
-        printf("Round Robin Scheduling (quantum = %d time units)\n", quantum);
-    } else {
-        printf("FCFS Scheduling\n");
+    if (opts.batch == true) {
+        simulate_batch(&opts);
+        free(opts.inputs);
+        return 0;
     }
 
-    // read input
-    int num_processes; 
-    int units_same_switch; // switch to new thread in same process
-    int units_diff_switch; // switch to new thread in different process
-    fgets(line, MAX_LEN - 1, stdin);
-    sscanf(line, "%d %d %d", &num_processes, &units_same_switch, &units_diff_switch); // first line always starts with this
-    if (num_processes <= 0) return 0;
-    if (units_same_switch < 0 || units_diff_switch < 0) {
-        fprintf(stderr, "ERROR: Invalid first line in input\n");
-        exit(-1);
+    if (opts.sample_spec.rate > 0) {
+        simulate_sampled(&opts);
+        free(opts.inputs);
+        return 0;
     }
-    total_num_threads = get_data(pq);
-
-    if (quantum <= 0) quantum = 1;
-    VerboseLine verbose_output[MAX_CAPACITY * 3 / 2 * total_num_threads * quantum];
-    int time_total = 0;
-    int cpu_time_total = 0;
-    int process_num = 0;
-    int turnaround_total = 0;
-    Thread *finished_threads[total_num_threads];
-    int thread_index = 0;
-    int thread_num = 0;
-    int last_burst_num = 0;
-    int verbose_counter = 0;
-
-// --------------------------------------- MAIN SIMULATION LOOP ---------------------------------------
-    // loop while there are still threads in the ready queue
-    while (pq->count > 0) {
-        Thread *cur_thread = PopMin(pq);
-
-        // Verbose Output for new to ready
-        if (v_flag == true && cur_thread->arrival_time == cur_thread->original_arrival_time) { 
-            VerboseLine new_verbose;
-            new_verbose.process_num = cur_thread->process_num;
-            new_verbose.thread_num = cur_thread->thread_num;
-            new_verbose.time = cur_thread->arrival_time;
-            new_verbose.state1 = NEW_NUM;
-            new_verbose.state2 = READY_NUM;
-            verbose_output[verbose_counter++] = new_verbose;
-        }
-        
-        // not first time through
-        if (time_total != 0) {
-            if (process_num == cur_thread->process_num) { // context switch - same process
-                if (thread_num != cur_thread->thread_num) { // different thread number
-                    time_total += units_same_switch;
-                } else if (last_burst_num != cur_thread->current_burst - 1) { // same thread number AND last burst isn't the same
-                    time_total += cur_thread->io_burst_times[cur_thread->current_burst - 1];
-                }
-            } else { // context switch - different process
-                time_total += units_diff_switch;
-            }
-            // set time entering CPU for this thread
-            cur_thread->time_enters_cpu = time_total;
-            last_burst_num = cur_thread->current_burst - 1;
-        }
-        // where time total matches "Time Enters CPU" 
-        
-        // Verbose Output for ready to running
-        if (v_flag == true) { 
-            VerboseLine new_verbose;
-            new_verbose.process_num = cur_thread->process_num;
-            new_verbose.thread_num = cur_thread->thread_num;
-            new_verbose.time = time_total;
-            new_verbose.state1 = READY_NUM;
-            new_verbose.state2 = RUNNING_NUM;
-            verbose_output[verbose_counter++] = new_verbose;
-        }
 
-        // update total times and the arrival time, as well as increment the current burst of the thread
-        if (r_flag == true) { // Round Robin calculations
-            int remaining_time = cur_thread->cpu_burst_times[cur_thread->current_burst] - quantum;
-            if (remaining_time <= 0) { // burst finished
-                remaining_time = 0; // reset to 0
-                cpu_time_total += cur_thread->cpu_burst_times[cur_thread->current_burst];
-                time_total += cur_thread->cpu_burst_times[cur_thread->current_burst];
-                cur_thread->arrival_time = cur_thread->cpu_burst_times[cur_thread->current_burst] + 
-                        cur_thread->io_burst_times[cur_thread->current_burst] + cur_thread->time_enters_cpu;
-                cur_thread->current_burst++;
-            } else { // otherwise burst didn't finish
-                cpu_time_total += quantum;
-                time_total += quantum;
-                cur_thread->cpu_burst_times[cur_thread->current_burst] = remaining_time;
-                cur_thread->arrival_time = quantum + cur_thread->time_enters_cpu;
-            }
-        } else { // FCFS calculations
-            cpu_time_total += cur_thread->cpu_burst_times[cur_thread->current_burst];
-            time_total += cur_thread->cpu_burst_times[cur_thread->current_burst];
-            cur_thread->arrival_time = cur_thread->cpu_burst_times[cur_thread->current_burst]
-                    + cur_thread->io_burst_times[cur_thread->current_burst] + cur_thread->time_enters_cpu;
-            cur_thread->current_burst++;
-        }
-        process_num = cur_thread->process_num;
-        thread_num = cur_thread->thread_num;
-        
-        // add thread back into queue unless it has finished
-        if (cur_thread->current_burst < cur_thread->burst_num) {   
-            insert(pq, cur_thread);
-
-            // Verbose Output for running to blocked and blocked to ready
-            if (v_flag == true) { 
-                // Verbose Output from running to blocked
-                VerboseLine new_verbose;
-                new_verbose.process_num = cur_thread->process_num;
-                new_verbose.thread_num = cur_thread->thread_num;
-                new_verbose.time = cur_thread->arrival_time - cur_thread->io_burst_times[cur_thread->current_burst - 1];
-                new_verbose.state1 = RUNNING_NUM;
-                new_verbose.state2 = BLOCKED_NUM;
-                verbose_output[verbose_counter++] = new_verbose;
-                // Verbose Output for blocked to ready
-                VerboseLine new_verbose2;
-                new_verbose2.process_num = cur_thread->process_num;
-                new_verbose2.thread_num = cur_thread->thread_num;
-                new_verbose2.time = cur_thread->arrival_time;
-                new_verbose2.state1 = BLOCKED_NUM;
-                new_verbose2.state2 = READY_NUM;
-                verbose_output[verbose_counter++] = new_verbose2;
-            }
-            free_thread(cur_thread);
-        } else { // last burst finished
-            // get thread turnaround time
-            cur_thread->time_finished = time_total;
-            finished_threads[thread_index++] = cur_thread;
-
-            // Verbose Output for running to terminated
-            if (v_flag == true) { 
-                // printf("At time %d: Thread %d of Process %d moves from %s to %s\n", time_total,
-                //         cur_thread->thread_num, cur_thread->process_num, STATE_RUNNING, STATE_TERMINATED);
-                VerboseLine new_verbose;
-                new_verbose.process_num = cur_thread->process_num;
-                new_verbose.thread_num = cur_thread->thread_num;
-                new_verbose.time = time_total;
-                new_verbose.state1 = RUNNING_NUM;
-                new_verbose.state2 = TERMINATED_NUM;
-                verbose_output[verbose_counter++] = new_verbose;
-            }
-        }
-
-    } // end while loop
-// --------------------------------------- END OF MAIN SIMULATION LOOP ---------------------------------------
-    // sort threads so they are in order for printing (easier to read)
-    for(i = 0; i < total_num_threads - 1; i++) {
-        for(j = i + 1; j < total_num_threads; j++) {
-            if(finished_threads[i]->process_num > finished_threads[j]->process_num) {
-                Thread *temp = finished_threads[i];
-                finished_threads[i] = finished_threads[j];
-                finished_threads[j] = temp;
-            } else if (finished_threads[i]->process_num == finished_threads[j]->process_num && finished_threads[i]->thread_num > finished_threads[j]->thread_num) {
-                Thread *temp = finished_threads[i];
-                finished_threads[i] = finished_threads[j];
-                finished_threads[j] = temp;
-            }
-        }
-    }
-    // sort verbose lines so they are in order for printing (easier to read)
-    if (v_flag == true) {
-        for(i = 0; i < verbose_counter - 1; i++) {
-            for(j = i + 1; j < verbose_counter; j++) {
-                if(verbose_output[i].time > verbose_output[j].time) {
-                    VerboseLine temp = verbose_output[i];
-                    verbose_output[i] = verbose_output[j];
-                    verbose_output[j] = temp;
-                } else if (verbose_output[i].time == verbose_output[j].time && (verbose_output[i].state1 == NEW_NUM || verbose_output[j].state1 == NEW_NUM)
-                        && verbose_output[i].state1 > verbose_output[j].state1) {
-                    VerboseLine temp = verbose_output[i];
-                    verbose_output[i] = verbose_output[j];
-                    verbose_output[j] = temp;
-                }
-            }
+    SimcpuConfig config;
+    simcpu_config_init(&config);
+    config.policy = policy_name(opts.policy);
+    config.quantum = opts.quantum > 0 ? opts.quantum : 0;
+    config.cores = opts.cores;
+    config.migration_cost = opts.migration_cost;
+    config.count = opts.s_flag == true || opts.stats_json_path != NULL;
+    config.keep_threads = opts.d_flag == true || opts.v_flag == true;
+    config.events = opts.v_flag;
+    config.max_resident = opts.max_resident;
+    config.checkpoint_path = opts.checkpoint_path;
+    config.checkpoint_time = opts.checkpoint_time;
+    config.output = stdout;
+    if (opts.output_path != NULL) {
+        config.output = fopen(opts.output_path, "w");
+        if (config.output == NULL) {
+            perror(opts.output_path);
+            exit(-1);
         }
     }
+    config.output_format = output_format_name(opts.format);
+    simcpu_print_policy(&config, stdout);
 
-    // get the turnaround time total for the processes
-    int current_process_num = finished_threads[0]->process_num;
-    int highest_time = finished_threads[0]->time_finished;
-    int lowest_arrival = finished_threads[0]->original_arrival_time;
-    for (i = 0; i < total_num_threads; i++) {
-        if (current_process_num == finished_threads[i]->process_num) {
-            if (finished_threads[i]->time_finished > highest_time) {
-                highest_time = finished_threads[i]->time_finished;
-            }
-            if (finished_threads[i]->original_arrival_time < lowest_arrival) {
-                lowest_arrival = finished_threads[i]->original_arrival_time;
-            } 
-        } else {
-            turnaround_total += highest_time - lowest_arrival; // add turnaround time of the process to the total
-            highest_time = finished_threads[i]->time_finished; // new process, so reset highest time and lowest arrival
-            lowest_arrival = finished_threads[i]->original_arrival_time;
-        }
-        current_process_num = finished_threads[i]->process_num;
+    // read input, either all of it now or (streaming) one thread ahead of the simulation
+    SimcpuContext *ctx = simcpu_create();
+    if (opts.stream == true) {
+        if (simcpu_open_stream(ctx, opts.input_path) != 0) exit_with_error(ctx);
+    } else {
+        if (simcpu_load_file(ctx, opts.input_path) != 0) exit_with_error(ctx);
     }
-    // add turnaround time of last process
-    turnaround_total += highest_time - lowest_arrival;
-
-    // verbose output
-    if (v_flag == true) {
-        for (i = 0; i < verbose_counter; i++) {
-            printf("At time %d: Thread %d of Process %d moves from %s to %s\n", verbose_output[i].time,
-                    verbose_output[i].thread_num, verbose_output[i].process_num, states[verbose_output[i].state1], states[verbose_output[i].state2]);
-        }
+    if (simcpu_process_count(ctx) <= 0) return 0;
+    if (opts.resume_path != NULL) {
+        int resume_time;
+        if (simcpu_resume(ctx, opts.resume_path, &resume_time) != 0) exit_with_error(ctx);
+        printf("Resumed at time %d from %s\n", resume_time, opts.resume_path);
     }
 
+    SimcpuResults res;
+    if (simcpu_run(ctx, &config, &res) != 0) exit_with_error(ctx);
+
     // Default output
-    printf("Total Time Required = %d units\nAverage Turnaround Time is %.1f units\nCPU Utilization is %2.1f%%\n", time_total,
-            (double)turnaround_total / (double)num_processes, 100 * (double)cpu_time_total / (double)time_total);
+    printf("Total Time Required = %d units\nAverage Turnaround Time is %.1f units\n", res.time_total, res.average_turnaround);
+    if (opts.latency == true) {
+        print_percentiles("Thread Turnaround", &res.turnaround);
+        print_percentiles("Thread Waiting", &res.waiting);
+        print_percentiles("Thread Response", &res.response);
+    }
+    printf("CPU Utilization is %2.1f%%\n", res.cpu_utilization);
+    for (i = 0; i < res.cores; i++) {
+        SimcpuCoreResult core;
+        simcpu_core(ctx, i, &core);
+        printf("Core %d Utilization is %2.1f%% (%ld dispatches, %ld migrations, %ld steals)\n", i, core.utilization,
+                core.dispatches, core.migrations, core.steals);
+    }
 
     // Detailed Mode output (also printed in verbose mode)
-    if (d_flag == true || v_flag == true) {
-        for (i = 0; i < total_num_threads; i++) {
-            // get service time and I/O time
-            printf("Thread %d of Process %d:\n  arrival time: %d\n  service time: %d units,"
-                    " I/O time: %d units, turnaround time: %d units, finish time: %d units\n", finished_threads[i]->thread_num, finished_threads[i]->process_num,
-                    finished_threads[i]->original_arrival_time, finished_threads[i]->service_time, finished_threads[i]->io_time,
-                    finished_threads[i]->time_finished - finished_threads[i]->original_arrival_time, finished_threads[i]->time_finished);
+    if (config.keep_threads) simcpu_write_threads(ctx);
+
+    if (config.count) {
+        FILE *json = NULL;
+        if (opts.stats_json_path != NULL && strcmp(opts.stats_json_path, "-") == 0) {
+            json = stdout;
+        } else if (opts.stats_json_path != NULL) {
+            json = fopen(opts.stats_json_path, "w");
+            if (json == NULL) {
+                fprintf(stderr, "ERROR: cannot write statistics to %s\n", opts.stats_json_path);
+                exit(-1);
+            }
         }
+        simcpu_write_stats(ctx, opts.s_flag ? stdout : NULL, json);
+        if (json != NULL && json != stdout) fclose(json);
     }
 
-    // free threads 
-    for (i = 0; i < total_num_threads; i++) {
-        free_thread(finished_threads[i]);
-    }
-    // free priority queue
-    if (pq != NULL && pq->arr != NULL) free(pq->arr);
-    if (pq != NULL) free(pq);
+    simcpu_close_output(ctx);
+    if (config.output != stdout) fclose(config.output);
+    // free all threads and their bursts at once
+    simcpu_destroy(ctx);
 
     return 0;
 }
 
 /*--------------------------------- HELPER FUNCTIONS ---------------------------------*/
 
-// Gets the data from the input file (from stdin) and returns number of threads across all processes
-int get_data(PriorityQueue *pq) {
-    char line[MAX_LEN];
-    int total_threads = 0;
-    fgets(line, MAX_LEN - 1, stdin);
-    while (line != NULL) {
-        int num_threads = 0, process_num = 0;
-        int i, j;
-        sscanf(line, "%d %d", &process_num, &num_threads);
-        total_threads += num_threads;
-        for (i = 0; i < num_threads; i++) {
-            fgets(line, MAX_LEN - 1, stdin);
-            // store the info in a Thread
-            Thread temp;
-            temp.process_num = process_num;
-            temp.num_threads = num_threads;
-            sscanf(line, "%d %d %d", &(temp.thread_num), &(temp.arrival_time), &(temp.burst_num));
-            temp.cpu_burst_times = malloc(temp.burst_num * sizeof(int));
-            temp.io_burst_times = malloc(temp.burst_num * sizeof(int));
-            temp.time_enters_cpu = 0;
-            temp.time_finished = 0;
-            temp.current_burst = 0;
-            temp.original_arrival_time = temp.arrival_time;
-            temp.service_time = 0;
-            temp.io_time = 0;
-            // get the bursts
-            for (j = 0; j < temp.burst_num; j++) {
-                if ( (fgets(line, MAX_LEN - 1, stdin)) == NULL || line == NULL) break;
-                int burst;
-                if (j < temp.burst_num - 1) {
-                    sscanf(line, "%d %d %d", &burst, &(temp.cpu_burst_times[j]), &(temp.io_burst_times[j]));
-                    temp.service_time += temp.cpu_burst_times[j];
-                    temp.io_time += temp.io_burst_times[j];
-                } else {
-                    sscanf(line, "%d %d", &burst, &(temp.cpu_burst_times[j]));
-                    temp.io_burst_times[j] = 0;
-                    temp.service_time += temp.cpu_burst_times[j];
-                }
-            }
-            // add the Thread to the Priority Queue
-            insert(pq, &temp);
-            free(temp.cpu_burst_times);
-            free(temp.io_burst_times);
-        }
-        if ( (fgets(line, MAX_LEN - 1, stdin)) == NULL) break;
-    }
-    return total_threads;
-}
-
-// returns the quantum and sets the flags to true if they exist
-int set_flags(bool* d, bool *v, bool *r, int argc, char *argv[]) {
+// sets the options from the command line arguments, returns FAILURE if they are invalid
+int set_flags(Options *opts, int argc, char *argv[]) {
     int i;
-    int quantum = 0;
-    if (argc < 1 || argc > 5) return -1; // invalid number of arguments
-    for (i = 0; i < argc; i++) {
-        if (strcmp(argv[i], "-d") == 0) *d = true;
-        else if (strcmp(argv[i], "-v") == 0) *v = true;
+    opts->d_flag = false;
+    opts->v_flag = false;
+    opts->r_flag = false;
+    opts->p_flag = false;
+    opts->policy = POLICY_FCFS;
+    opts->format = FORMAT_TEXT;
+    opts->output_path = NULL;
+    opts->latency = false;
+    opts->s_flag = false;
+    opts->stats_json_path = NULL;
+    opts->quantum = -1;
+    opts->input_path = NULL;
+    opts->convert_path = NULL;
+    opts->stream = false;
+    opts->max_resident = 0;
+    opts->cores = 1;
+    opts->migration_cost = 0;
+    opts->checkpoint_time = 0;
+    opts->checkpoint_path = NULL;
+    opts->resume_path = NULL;
+    opts->sweep = false;
+    memset(&opts->sweep_spec, 0, sizeof(SweepSpec));
+    opts->sample_spec.rate = 0;
+    opts->sample_spec.windows = 0;
+    opts->batch = false;
+    opts->inputs = malloc(argc * sizeof(char *));
+    opts->num_inputs = 0;
+    if (opts->inputs == NULL) {
+        fprintf(stderr, "malloc() failed for the input file names.\n");
+        exit(-1);
+    }
+    for (i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-d") == 0) opts->d_flag = true;
+        else if (strcmp(argv[i], "-v") == 0) opts->v_flag = true;
+        else if (strcmp(argv[i], "-s") == 0) opts->s_flag = true;
+        else if (strcmp(argv[i], "--latency") == 0) opts->latency = true;
+        else if (strcmp(argv[i], "--format") == 0) {
+            if (argc > i + 1 && parse_output_format(argv[i + 1], &opts->format)) i++;
+            else return FAILURE;
+        } else if (strcmp(argv[i], "--output") == 0) {
+            if (argc > i + 1) opts->output_path = argv[++i];
+            else return FAILURE;
+        }
         else if (strcmp(argv[i], "-r") == 0) {
-            *r = true;
+            opts->r_flag = true;
             if (argc > i + 1) {
-                quantum = atoi(argv[i + 1]);
-                if (quantum <= 0) return -1;
+                opts->quantum = atoi(argv[i + 1]);
+                if (opts->quantum <= 0) return FAILURE;
                 i++; // skip that argument on next iteration
-            } else return -1;
+            } else return FAILURE;
+        } else if (strcmp(argv[i], "-p") == 0) {
+            if (argc > i + 1 && parse_policy(argv[i + 1], &opts->policy)) opts->p_flag = true;
+            else return FAILURE;
+            i++;
+        } else if (strcmp(argv[i], "--stats-json") == 0) {
+            if (argc > i + 1) opts->stats_json_path = argv[++i];
+            else return FAILURE;
+        } else if (strcmp(argv[i], "--stream") == 0) {
+            opts->stream = true;
+        } else if (strcmp(argv[i], "--max-resident") == 0) {
+            if (argc > i + 1) opts->max_resident = atoi(argv[++i]);
+            if (opts->max_resident <= 0) return FAILURE;
+        } else if (strcmp(argv[i], "--cores") == 0) {
+            if (argc > i + 1) opts->cores = atoi(argv[++i]);
+            else return FAILURE;
+            if (opts->cores <= 0) return FAILURE;
+        } else if (strcmp(argv[i], "--migration-cost") == 0) {
+            if (argc > i + 1) opts->migration_cost = atoi(argv[++i]);
+            else return FAILURE;
+            if (opts->migration_cost < 0) return FAILURE;
+        } else if (strcmp(argv[i], "--checkpoint") == 0) {
+            if (argc > i + 2) {
+                opts->checkpoint_time = atoi(argv[++i]);
+                opts->checkpoint_path = argv[++i];
+            } else return FAILURE;
+            if (opts->checkpoint_time < 0) return FAILURE;
+        } else if (strcmp(argv[i], "--resume") == 0) {
+            if (argc > i + 1) opts->resume_path = argv[++i];
+            else return FAILURE;
+        } else if (strcmp(argv[i], "--sweep") == 0) {
+            opts->sweep = true;
+        } else if (strcmp(argv[i], "--policies") == 0) {
+            if (argc > i + 1) opts->sweep_spec.num_policies = parse_policy_list(argv[++i], &opts->sweep_spec.policies);
+            if (opts->sweep_spec.num_policies <= 0) return FAILURE;
+        } else if (strcmp(argv[i], "--quanta") == 0) {
+            if (argc > i + 1) opts->sweep_spec.num_quanta = parse_int_list(argv[++i], &opts->sweep_spec.quanta);
+            if (opts->sweep_spec.num_quanta <= 0) return FAILURE;
+        } else if (strcmp(argv[i], "--switch-costs") == 0) {
+            if (argc > i + 1) opts->sweep_spec.num_switch_costs = parse_switch_costs(argv[++i], &opts->sweep_spec.switch_costs);
+            if (opts->sweep_spec.num_switch_costs <= 0) return FAILURE;
+        } else if (strcmp(argv[i], "--jobs") == 0) {
+            if (argc > i + 1) opts->sweep_spec.jobs = atoi(argv[++i]);
+            if (opts->sweep_spec.jobs <= 0) return FAILURE;
+        } else if (strcmp(argv[i], "--sample") == 0) {
+            if (argc > i + 1) opts->sample_spec.rate = atof(argv[++i]);
+            if (opts->sample_spec.rate <= 0 || opts->sample_spec.rate >= 1) return FAILURE;
+        } else if (strcmp(argv[i], "--windows") == 0) {
+            if (argc > i + 1) opts->sample_spec.windows = atoi(argv[++i]);
+            if (opts->sample_spec.windows < 2) return FAILURE;
+        } else if (strcmp(argv[i], "--batch") == 0) {
+            opts->batch = true;
+        } else if (strcmp(argv[i], "--convert") == 0) {
+            if (argc > i + 1) opts->convert_path = argv[++i];
+            else return FAILURE;
+        } else if (argv[i][0] == '-' && argv[i][1] != '\0') {
+            return FAILURE; // unknown flag
+        } else {
+            opts->inputs[opts->num_inputs++] = argv[i];
         }
     }
-    return quantum;
-}
-
-void free_thread(Thread *t) {
-    if (t == NULL) return;
-    if (t->cpu_burst_times != NULL) free(t->cpu_burst_times);
-    if (t->io_burst_times != NULL) free(t->io_burst_times);
-    if (t != NULL) free(t);
-    t = NULL;
+    if (opts->p_flag == false && opts->r_flag == true) opts->policy = POLICY_RR;
+    if (opts->sample_spec.windows != 0 && opts->sample_spec.rate == 0) return FAILURE; // only for sampling
+    if (opts->sample_spec.rate > 0 && (opts->batch || opts->sweep)) return FAILURE;
+    if (opts->batch == true) return set_batch_flags(opts);
+    if (opts->num_inputs > 1) return FAILURE; // more than one input file
+    if (opts->num_inputs == 1 && strcmp(opts->inputs[0], "-") != 0) opts->input_path = opts->inputs[0];
+    if (opts->format == FORMAT_TRACE) opts->v_flag = true; // the trace is made of the transitions
+    if (opts->format != FORMAT_TEXT && opts->output_path == NULL) return FAILURE; // not mixed in with the results
+    if (opts->sweep == true) return set_sweep_flags(opts);
+    if (opts->sweep_spec.num_policies != 0 || opts->sweep_spec.num_quanta != 0 || opts->sweep_spec.num_switch_costs != 0
+            || opts->sweep_spec.jobs != 0) return FAILURE; // only for a sweep
+    if (opts->policy == POLICY_RR && opts->r_flag == false) return FAILURE; // round robin needs a quantum
+    if (opts->cores > 1 && policy_supports_cores(opts->policy) == false) return FAILURE;
+    // the whole workload must be loaded to save or restore it, on one core; the transitions before
+    // a resumed run are not known, so it cannot be verbose
+    if (opts->checkpoint_path != NULL || opts->resume_path != NULL) {
+        if (opts->stream || opts->cores > 1 || opts->convert_path != NULL) return FAILURE;
+        if (opts->checkpoint_path != NULL && opts->resume_path != NULL) return FAILURE;
+        if (opts->resume_path != NULL && opts->v_flag) return FAILURE;
+    }
+    // a sampled run only gives the headline results, simulated on one core from a loaded workload
+    if (opts->sample_spec.rate > 0) {
+        if (opts->d_flag || opts->v_flag || opts->s_flag || opts->latency || opts->stats_json_path != NULL || opts->stream
+                || opts->cores > 1 || opts->checkpoint_path != NULL || opts->resume_path != NULL || opts->convert_path != NULL
+                || opts->output_path != NULL) return FAILURE;
+        if (opts->sample_spec.windows == 0) opts->sample_spec.windows = SAMPLE_DEFAULT_WINDOWS;
+    }
+    return SUCCESS;
 }
 
-/* ---------------------------------- HEAP FUNCTIONS ---------------------------------- */
-
-PriorityQueue *CreateHeap(int capacity){
-    PriorityQueue *h = (PriorityQueue*) malloc(sizeof(PriorityQueue)); //one is number of heap
-
-    //check if memory allocation is fails
-    if(h == NULL){
-        printf("Memory Error!");
-        return NULL;
+// fills in the sweep's lists from the single-run flags where none were given, returns FAILURE if the
+// sweep cannot run
+int set_sweep_flags(Options *opts) {
+    SweepSpec *spec = &opts->sweep_spec;
+    int i;
+    if (opts->d_flag || opts->v_flag || opts->stream || opts->convert_path != NULL || opts->stats_json_path != NULL
+            || opts->latency || opts->output_path != NULL) return FAILURE; // the sweep always gives percentiles
+    if (opts->checkpoint_path != NULL || (opts->resume_path != NULL && opts->cores > 1)) return FAILURE;
+    if (spec->num_policies == 0) {
+        spec->policies = &opts->policy;
+        spec->num_policies = 1;
     }
-    h->count = 0;
-    h->capacity = capacity;
-    h->arr = malloc(capacity * sizeof(Thread*)); //size in bytes
-
-    //check if allocation succeed
-    if ( h->arr == NULL){
-        printf("Memory Error!");
-        return NULL;
+    if (spec->num_quanta == 0 && opts->r_flag == true) {
+        spec->quanta = &opts->quantum;
+        spec->num_quanta = 1;
+    }
+    spec->cores = opts->cores;
+    spec->migration_cost = opts->migration_cost;
+    for (i = 0; i < spec->num_policies; i++) {
+        if (spec->policies[i] == POLICY_RR && spec->num_quanta == 0) return FAILURE; // round robin needs a quantum
+        if (opts->cores > 1 && policy_supports_cores(spec->policies[i]) == false) return FAILURE;
     }
-    return h;
+    return SUCCESS;
 }
 
-void insert(PriorityQueue *pq, Thread *key){
+// checks the options of a batch, returns FAILURE if it cannot run: only the policy flags apply
+int set_batch_flags(Options *opts) {
     int i;
-    if( pq->count < pq->capacity){
-        pq->arr[pq->count] = malloc(sizeof(Thread));
-        if (pq->arr[pq->count] == NULL) {
-            fprintf(stderr, "malloc() failed for inserting Thread to Priority Queue.\n");
-            exit(-1);
-        }
-        // copy all data
-        pq->arr[pq->count]->arrival_time = key->arrival_time;
-        pq->arr[pq->count]->original_arrival_time = key->original_arrival_time;
-        pq->arr[pq->count]->thread_num = key->thread_num;
-        pq->arr[pq->count]->burst_num = key->burst_num;
-        pq->arr[pq->count]->process_num = key->process_num;
-        pq->arr[pq->count]->current_burst = key->current_burst;
-        pq->arr[pq->count]->time_enters_cpu = key->time_enters_cpu;
-        pq->arr[pq->count]->time_finished = key->time_finished;
-        pq->arr[pq->count]->num_threads = key->num_threads;
-        pq->arr[pq->count]->cpu_burst_times = malloc(key->burst_num * sizeof(int));
-        pq->arr[pq->count]->io_burst_times = malloc(key->burst_num * sizeof(int));
-        pq->arr[pq->count]->io_time = key->io_time;
-        pq->arr[pq->count]->service_time = key->service_time;
-        for (i = 0; i < key->burst_num; i++) { // copy burst times
-            pq->arr[pq->count]->cpu_burst_times[i] = key->cpu_burst_times[i];
-            if (i < key->burst_num - 1) {
-                pq->arr[pq->count]->io_burst_times[i] = key->io_burst_times[i];
-            }
-        }
-        up_heap(pq, pq->count);
-        pq->count++;
+    if (opts->d_flag || opts->v_flag || opts->s_flag || opts->stream || opts->convert_path != NULL || opts->stats_json_path != NULL
+            || opts->latency || opts->output_path != NULL || opts->sweep || opts->checkpoint_path != NULL
+            || opts->resume_path != NULL) return FAILURE;
+    if (opts->sweep_spec.num_policies != 0 || opts->sweep_spec.num_quanta != 0 || opts->sweep_spec.num_switch_costs != 0
+            || opts->sweep_spec.jobs != 0) return FAILURE;
+    if (opts->num_inputs == 0) return FAILURE;
+    for (i = 0; i < opts->num_inputs; i++) {
+        if (strcmp(opts->inputs[i], "-") == 0) return FAILURE; // files only
     }
+    if (opts->policy == POLICY_RR && opts->r_flag == false) return FAILURE;
+    if (opts->cores > 1 && policy_supports_cores(opts->policy) == false) return FAILURE;
+    return SUCCESS;
 }
 
-void up_heap(PriorityQueue *h,int index){
-    Thread *temp;
-    int parent_node = (index-1)/2;
+// loads every input file of the batch, simulates them all and prints a CSV row for each, in the
+// order given
+void simulate_batch(const Options *opts) {
+    int n = opts->num_inputs;
+    int i;
+    assert(n > 0); // set_batch_flags needs at least one input
+    Workload *workloads = malloc(n * sizeof(Workload));
+    Workload **pointers = calloc(n, sizeof(Workload *));
+    BatchResult *results = malloc(n * sizeof(BatchResult));
+    if (workloads == NULL || pointers == NULL || results == NULL) {
+        fprintf(stderr, "malloc() failed for the batch of workloads.\n");
+        exit(-1);
+    }
+    for (i = 0; i < n; i++) {
+        load_workload(opts->inputs[i], &workloads[i], NULL);
+        pointers[i] = &workloads[i];
+    }
 
-    if(h->arr[parent_node]->arrival_time > h->arr[index]->arrival_time){
-        //swap and recursive call
-        temp = h->arr[parent_node];
-        h->arr[parent_node] = h->arr[index];
-        h->arr[index] = temp;
-        up_heap(h,parent_node);
-    } else if (h->arr[parent_node]->arrival_time == h->arr[index]->arrival_time
-            && h->arr[parent_node]->process_num > h->arr[index]->process_num) { // compares by process number if arrival time is the same
-        //swap and recursive call
-        temp = h->arr[parent_node];
-        h->arr[parent_node] = h->arr[index];
-        h->arr[index] = temp;
-        up_heap(h,parent_node);
+    SimConfig config;
+    memset(&config, 0, sizeof(SimConfig));
+    config.policy = opts->policy;
+    config.quantum = opts->quantum;
+    config.cores = opts->cores;
+    config.migration_cost = opts->migration_cost;
+    run_batch(pointers, n, &config, results);
+
+    printf("input,threads,total_time,average_turnaround,cpu_utilization,dispatches\n");
+    for (i = 0; i < n; i++) {
+        BatchResult *res = &results[i];
+        int num_processes = workloads[i].num_processes;
+        printf("%s,%d,%d,%.1f,%.1f,%ld\n", opts->inputs[i], res->threads, res->time_total,
+                num_processes > 0 ? (double)res->turnaround_total / num_processes : 0.0,
+                res->time_total > 0 ? 100 * (double)res->cpu_time_total / ((double)res->time_total * config.cores) : 0.0,
+                res->dispatches);
+        free_workload(&workloads[i]);
     }
+    free(workloads);
+    free(pointers);
+    free(results);
 }
 
-// parent_node is the index of the parent node
-void down_heap(PriorityQueue *h, int parent_node){
-    int left = parent_node * 2 + 1;
-    int right = parent_node * 2 + 2;
-    int min;
-    Thread *temp;
-
-    if(left >= h->count || left <0)
-        left = -1;
-    if(right >= h->count || right <0)
-        right = -1;
-
-    if(left != -1 && h->arr[left]->arrival_time < h->arr[parent_node]->arrival_time) // sort by arrival time
-        min = left;
-    else
-        min = parent_node;
-    if(right != -1 && h->arr[right]->arrival_time < h->arr[min]->arrival_time)
-        min = right;
-
-    if(min != parent_node){
-        temp = h->arr[min];
-        h->arr[min] = h->arr[parent_node];
-        h->arr[parent_node] = temp;
-
-        // recursive  call
-        down_heap(h, min);
+// estimates the results of the input from a sample of its windows and prints them with their
+// confidence intervals, in place of the default output
+void simulate_sampled(const Options *opts) {
+    Workload workload;
+    SimConfig config;
+    SampleResult res;
+    memset(&config, 0, sizeof(SimConfig));
+    config.policy = opts->policy;
+    config.quantum = opts->quantum;
+    config.cores = 1;
+    print_policy_header(&config, stdout);
+    load_workload(opts->input_path, &workload, NULL);
+    if (workload.num_processes <= 0) return;
+    run_sampled(&workload, &config, &opts->sample_spec, &res);
+    if (res.exact) { // the exact results, as without --sample
+        printf("Simulated in full, as %s\n", res.windows_truncated > 0 ? "the sampled windows fall behind the arrivals"
+                : "a sample would simulate most of the CPU time");
+        printf("Total Time Required = %.0f units\nAverage Turnaround Time is %.1f units\n", res.time_total.value,
+                res.average_turnaround.value);
+        printf("CPU Utilization is %2.1f%%\n", res.cpu_utilization.value);
+    } else {
+        printf("Sampled %d of %d windows (%.1f%% of the CPU time simulated), with 95%% confidence intervals\n",
+                res.windows_sampled, res.windows, 100 * (double)res.cpu_time_simulated / (double)res.cpu_time_total);
+        printf("Total Time Required = %.0f units (+/- %.0f)\nAverage Turnaround Time is %.1f units (+/- %.1f)\n",
+                res.time_total.value, res.time_total.error, res.average_turnaround.value, res.average_turnaround.error);
+        printf("CPU Utilization is %2.1f%% (+/- %.1f)\n", res.cpu_utilization.value, res.cpu_utilization.error);
     }
+    free_workload(&workload);
 }
 
-Thread* PopMin(PriorityQueue *h){
-    Thread* pop;
-    if(h == NULL || h->arr == NULL || h->count == 0){ // return NULL if empty or invalid
-        return NULL;
-    }
-    // replace first node by last and delete last
-    pop = h->arr[0];
-    h->arr[0] = h->arr[h->count-1];
-    h->count--;
-    down_heap(h, 0);
-    return pop;
-}
\ No newline at end of file
+// prints why the simulator failed and exits
+void exit_with_error(const SimcpuContext *ctx) {
+    fprintf(stderr, "ERROR: %s\n", simcpu_error(ctx));
+    exit(-1);
+}
+
+// prints the percentiles of one of the threads' times, as the --latency flag asks
+void print_percentiles(const char *name, const SimcpuTimes *times) {
+    printf("%s Time percentiles: p50 %d, p90 %d, p99 %d, p99.9 %d units\n", name, times->p50, times->p90, times->p99,
+            times->p999);
+}
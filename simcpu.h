@@ -0,0 +1,52 @@
+/**
+ * simcpu.h
+ * Definitions shared between the simulator's source files
+ */
+
+#ifndef SIMCPU_H
+#define SIMCPU_H
+
+#define STATE_NEW "NEW"
+#define STATE_READY "READY"
+#define STATE_RUNNING "RUNNING"
+#define STATE_BLOCKED "BLOCKED"
+#define STATE_TERMINATED "TERMINATED"
+
+#define NEW_NUM 0
+#define READY_NUM 1
+#define RUNNING_NUM 2
+#define BLOCKED_NUM 3
+#define TERMINATED_NUM 4
+
+typedef struct thread_struct {
+    int thread_num;
+    int num_threads;
+    int arrival_time;
+    int burst_num;
+    int process_num;
+    int original_arrival_time;
+    int time_finished;
+    int current_burst;
+    int time_enters_cpu;
+    int time_first_enters_cpu; // -1 until the thread first leaves the NEW state
+    int remaining;   // CPU time left in the current burst
+    int queue_level; // multilevel feedback queue level
+    int core;        // core the thread last ran on, -1 if it has not run yet
+    int service_time;
+    int io_time;
+    int *cpu_burst_times;
+    int *io_burst_times;
+} Thread;
+
+// every Thread of the workload, stored contiguously; heap nodes refer to them by index.
+// Slots of released (terminated) threads are reused by the next thread added.
+typedef struct thread_table_struct {
+    Thread *arr;
+    int count;    // slots in use or released
+    int capacity;
+    int *free_slots; // released slots, reused first
+    int free_count;
+    int resident_max; // high-water mark of threads held at once
+} ThreadTable;
+
+#endif
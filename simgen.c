@@ -0,0 +1,352 @@
+/**
+ * simgen.c
+ * Synthetic workload generator for simcpu, writing the text input format or the binary workload
+ * format (see binfmt.h). Usage:
+ *   ./simgen [-s seed] [-p processes] [-t threads_per_process] [-b bursts | -b min:max]
+ *            [--gap mean] [--cpu dist] [--io dist] [--switch same:diff] [--binary] [-o output_file]
+ * - threads arrive as a Poisson process with the given mean gap between arrivals, in the order
+ *   they are written, so the output is sorted by arrival time and can be streamed (--stream)
+ * - each thread gets a number of bursts drawn uniformly from min..max (all the same with -b n)
+ * - CPU and I/O burst times follow a distribution: exp:mean (exponential), pareto:alpha:min
+ *   (heavy tailed), uniform:lo:hi or const:value; CPU bursts are at least 1 unit and every burst
+ *   is capped at MAX_BURST units
+ * The same options and seed always give the same workload, in either format: every thread draws
+ * its bursts from its own generator, seeded from the seed and the thread's position.
+ * Text goes to standard output unless -o is given; binary output needs -o, and is written in place
+ * through a memory mapping of the output file.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "binfmt.h"
+
+#define SUCCESS 1
+#define FAILURE 0
+#define USAGE "Usage: ./simgen [-s seed] [-p processes] [-t threads_per_process] [-b bursts | -b min:max]\n" \
+        "                [--gap mean] [--cpu dist] [--io dist] [--switch same:diff] [--binary] [-o output_file]\n" \
+        "       dist: exp:mean | pareto:alpha:min | uniform:lo:hi | const:value\n"
+#define MAX_BURST 1000000 // keeps heavy tailed bursts (and the simulated times) within an int
+#define OUT_BUFFER_SIZE (1 << 20)
+
+typedef enum dist_kind { DIST_EXP, DIST_PARETO, DIST_UNIFORM, DIST_CONST } DistKind;
+
+typedef struct dist_struct {
+    DistKind kind;
+    double a; // mean, alpha, lo or value
+    double b; // min for pareto, hi for uniform
+} Dist;
+
+typedef struct gen_options_struct {
+    uint64_t seed;
+    int processes;
+    int threads;     // per process
+    int min_bursts;  // per thread
+    int max_bursts;
+    double gap;      // mean time between arrivals
+    Dist cpu;
+    Dist io;
+    int units_same_switch;
+    int units_diff_switch;
+    bool binary;
+    const char *output_path; // NULL for standard output
+} GenOptions;
+
+// buffered text output with hand-rolled number formatting
+typedef struct text_out_struct {
+    FILE *file;
+    char *buf;
+    size_t len;
+} TextOut;
+
+int set_gen_flags(GenOptions *opts, int argc, char *argv[]);
+
+/*--------------------------------- RANDOM NUMBERS ---------------------------------*/
+
+// splitmix64: a fast generator whose whole state is one 64-bit number, so a thread's generator is
+// cheap to seed from the seed and its position
+static inline uint64_t next_u64(uint64_t *state) {
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+// uniform double in [0, 1)
+static inline double next_unit(uint64_t *state) {
+    return (next_u64(state) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+// uniform int in lo..hi
+static inline int next_range(uint64_t *state, int lo, int hi) {
+    return lo + (int)(next_u64(state) % (uint64_t)(hi - lo + 1));
+}
+
+// draws a time from the distribution, rounded and clamped to lo..MAX_BURST
+static int sample(const Dist *d, uint64_t *state, int lo) {
+    double x;
+    switch (d->kind) {
+        case DIST_EXP: x = -d->a * log(1.0 - next_unit(state)); break;
+        case DIST_PARETO: x = d->b / pow(1.0 - next_unit(state), 1.0 / d->a); break;
+        case DIST_UNIFORM: x = d->a + (d->b - d->a + 1) * next_unit(state); x = floor(x); break;
+        default: x = d->a; break;
+    }
+    x = floor(x + 0.5);
+    if (x < lo) return lo;
+    if (x > MAX_BURST) return MAX_BURST;
+    return (int)x;
+}
+
+// generator of the thread at the given position, independent of every other thread's
+static uint64_t thread_state(uint64_t seed, uint64_t position) {
+    uint64_t state = seed ^ (position * 0xD1B54A32D192ED03ull);
+    next_u64(&state);
+    return state;
+}
+
+/*--------------------------------- TEXT OUTPUT ---------------------------------*/
+
+static void text_flush(TextOut *out) {
+    if (out->len > 0 && fwrite(out->buf, 1, out->len, out->file) != out->len) {
+        perror("simgen");
+        exit(-1);
+    }
+    out->len = 0;
+}
+
+// appends up to three numbers separated by spaces, and a newline
+static inline void text_line(TextOut *out, int count, int v0, int v1, int v2) {
+    int values[3] = {v0, v1, v2};
+    int i;
+    if (out->len + 40 > OUT_BUFFER_SIZE) text_flush(out);
+    for (i = 0; i < count; i++) {
+        char digits[12];
+        int n = 0;
+        unsigned int v = values[i] < 0 ? -(unsigned int)values[i] : (unsigned int)values[i];
+        if (i > 0) out->buf[out->len++] = ' ';
+        if (values[i] < 0) out->buf[out->len++] = '-';
+        do {
+            digits[n++] = '0' + v % 10;
+            v /= 10;
+        } while (v > 0);
+        while (n > 0) out->buf[out->len++] = digits[--n];
+    }
+    out->buf[out->len++] = '\n';
+}
+
+/*--------------------------------- GENERATION ---------------------------------*/
+
+// the arrival times no longer fit the formats' 32-bit integers, so they would wrap to negative values
+// (burst times cannot: sample() keeps them between 0 and MAX_BURST)
+static void arrival_overflow(const GenOptions *opts) {
+    fprintf(stderr, "ERROR: arrival times exceed %d units, use a smaller --gap or fewer threads\n", INT32_MAX);
+    if (opts->output_path != NULL) unlink(opts->output_path); // not a valid workload
+    exit(-1);
+}
+
+// writes the workload in the text input format
+static void generate_text(const GenOptions *opts) {
+    TextOut out;
+    int p, t, b;
+    uint64_t arrivals = thread_state(~opts->seed, 0); // the arrival process has its own generator
+    uint64_t position = 0;
+    double arrival = 0;
+    out.file = stdout;
+    if (opts->output_path != NULL) {
+        out.file = fopen(opts->output_path, "w");
+        if (out.file == NULL) {
+            perror(opts->output_path);
+            exit(-1);
+        }
+    }
+    out.buf = malloc(OUT_BUFFER_SIZE);
+    out.len = 0;
+    if (out.buf == NULL) {
+        fprintf(stderr, "malloc() failed for the output buffer.\n");
+        exit(-1);
+    }
+
+    text_line(&out, 3, opts->processes, opts->units_same_switch, opts->units_diff_switch);
+    for (p = 1; p <= opts->processes; p++) {
+        text_line(&out, 2, p, opts->threads, 0);
+        for (t = 1; t <= opts->threads; t++, position++) {
+            uint64_t state = thread_state(opts->seed, position);
+            int bursts = next_range(&state, opts->min_bursts, opts->max_bursts);
+            arrival += -opts->gap * log(1.0 - next_unit(&arrivals));
+            if (arrival > INT32_MAX) arrival_overflow(opts);
+            text_line(&out, 3, t, (int)arrival, bursts);
+            for (b = 1; b <= bursts; b++) {
+                int cpu = sample(&opts->cpu, &state, 1);
+                int io = sample(&opts->io, &state, 0);
+                if (b < bursts) text_line(&out, 3, b, cpu, io);
+                else text_line(&out, 2, b, cpu, 0);
+            }
+        }
+    }
+    text_flush(&out);
+    if (out.file != stdout && fclose(out.file) != 0) {
+        perror(opts->output_path);
+        exit(-1);
+    }
+    free(out.buf);
+}
+
+// Writes the workload in the binary format, straight into a mapping of the output file. The burst
+// counts are drawn first so the file can be sized, then every thread's generator is seeded again
+// to draw its bursts.
+static void generate_binary(const GenOptions *opts) {
+    uint64_t num_threads = (uint64_t)opts->processes * opts->threads;
+    uint64_t num_bursts = 0;
+    uint64_t arrivals = thread_state(~opts->seed, 0);
+    uint64_t i;
+    double arrival = 0;
+    int b;
+    Workload header_values;
+    BinHeader h;
+
+    header_values.num_processes = opts->processes;
+    header_values.units_same_switch = opts->units_same_switch;
+    header_values.units_diff_switch = opts->units_diff_switch;
+    for (i = 0; i < num_threads; i++) {
+        uint64_t state = thread_state(opts->seed, i);
+        num_bursts += next_range(&state, opts->min_bursts, opts->max_bursts);
+    }
+    uint64_t size = init_binary_header(&h, &header_values, num_threads, num_bursts);
+
+    int fd = open(opts->output_path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0 || ftruncate(fd, size) != 0) {
+        perror(opts->output_path);
+        exit(-1);
+    }
+    char *data = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (data == MAP_FAILED) {
+        perror(opts->output_path);
+        exit(-1);
+    }
+    memcpy(data, &h, sizeof(BinHeader));
+    int32_t *process_num = (int32_t *)(data + h.offsets[COL_PROCESS_NUM]);
+    int32_t *thread_num = (int32_t *)(data + h.offsets[COL_THREAD_NUM]);
+    int32_t *num_threads_col = (int32_t *)(data + h.offsets[COL_NUM_THREADS]);
+    int32_t *arrival_time = (int32_t *)(data + h.offsets[COL_ARRIVAL_TIME]);
+    int32_t *burst_num = (int32_t *)(data + h.offsets[COL_BURST_NUM]);
+    int32_t *service_time = (int32_t *)(data + h.offsets[COL_SERVICE_TIME]);
+    int32_t *io_time = (int32_t *)(data + h.offsets[COL_IO_TIME]);
+    int64_t *burst_offset = (int64_t *)(data + h.offsets[COL_BURST_OFFSET]);
+    int32_t *cpu_bursts = (int32_t *)(data + h.offsets[COL_CPU_BURSTS]);
+    int32_t *io_bursts = (int32_t *)(data + h.offsets[COL_IO_BURSTS]);
+
+    int64_t first_burst = 0;
+    for (i = 0; i < num_threads; i++) {
+        uint64_t state = thread_state(opts->seed, i);
+        int bursts = next_range(&state, opts->min_bursts, opts->max_bursts);
+        int32_t *cpu = cpu_bursts + first_burst;
+        int32_t *io = io_bursts + first_burst;
+        int service = 0, io_total = 0;
+        arrival += -opts->gap * log(1.0 - next_unit(&arrivals));
+        if (arrival > INT32_MAX) arrival_overflow(opts);
+        process_num[i] = 1 + (int)(i / opts->threads);
+        thread_num[i] = 1 + (int)(i % opts->threads);
+        num_threads_col[i] = opts->threads;
+        arrival_time[i] = (int)arrival;
+        burst_num[i] = bursts;
+        burst_offset[i] = first_burst;
+        for (b = 0; b < bursts; b++) {
+            cpu[b] = sample(&opts->cpu, &state, 1);
+            io[b] = sample(&opts->io, &state, 0);
+            if (b == bursts - 1) io[b] = 0; // the last burst has no I/O
+            service += cpu[b];
+            io_total += io[b];
+        }
+        service_time[i] = service;
+        io_time[i] = io_total;
+        first_burst += bursts;
+    }
+    if (munmap(data, size) != 0 || close(fd) != 0) {
+        perror(opts->output_path);
+        exit(-1);
+    }
+}
+
+/* --------------------------------------- MAIN --------------------------------------- */
+int main(int argc, char *argv[]) {
+    GenOptions opts;
+    if (set_gen_flags(&opts, argc, argv) == FAILURE) {
+        fprintf(stderr, USAGE);
+        exit(-1);
+    }
+    if (opts.binary) generate_binary(&opts);
+    else generate_text(&opts);
+    return 0;
+}
+
+/*--------------------------------- HELPER FUNCTIONS ---------------------------------*/
+
+// parses "kind:x[:y]" into d, returns FAILURE if it is not a valid distribution
+static int parse_dist(const char *text, Dist *d) {
+    char kind[16];
+    double a = 0, b = 0;
+    int n = sscanf(text, "%15[a-z]:%lf:%lf", kind, &a, &b);
+    if (n >= 2 && strcmp(kind, "exp") == 0 && a > 0) d->kind = DIST_EXP;
+    else if (n == 3 && strcmp(kind, "pareto") == 0 && a > 0 && b > 0) d->kind = DIST_PARETO;
+    else if (n == 3 && strcmp(kind, "uniform") == 0 && a >= 0 && b >= a) d->kind = DIST_UNIFORM;
+    else if (n >= 2 && strcmp(kind, "const") == 0 && a >= 0) d->kind = DIST_CONST;
+    else return FAILURE;
+    d->a = a;
+    d->b = b;
+    return SUCCESS;
+}
+
+// sets the options from the command line arguments, returns FAILURE if they are invalid
+int set_gen_flags(GenOptions *opts, int argc, char *argv[]) {
+    int i;
+    opts->seed = 1;
+    opts->processes = 10;
+    opts->threads = 10;
+    opts->min_bursts = 1;
+    opts->max_bursts = 10;
+    opts->gap = 10;
+    opts->cpu.kind = DIST_EXP;
+    opts->cpu.a = 20;
+    opts->io.kind = DIST_EXP;
+    opts->io.a = 50;
+    opts->units_same_switch = 3;
+    opts->units_diff_switch = 7;
+    opts->binary = false;
+    opts->output_path = NULL;
+    for (i = 1; i < argc; i++) {
+        const char *value = argc > i + 1 ? argv[i + 1] : NULL;
+        if (strcmp(argv[i], "--binary") == 0) {
+            opts->binary = true;
+            continue;
+        }
+        if (value == NULL) return FAILURE; // every other flag takes a value
+        i++;
+        if (strcmp(argv[i - 1], "-s") == 0) opts->seed = strtoull(value, NULL, 10);
+        else if (strcmp(argv[i - 1], "-p") == 0) opts->processes = atoi(value);
+        else if (strcmp(argv[i - 1], "-t") == 0) opts->threads = atoi(value);
+        else if (strcmp(argv[i - 1], "-b") == 0) {
+            if (sscanf(value, "%d:%d", &opts->min_bursts, &opts->max_bursts) != 2) {
+                opts->min_bursts = opts->max_bursts = atoi(value);
+            }
+        } else if (strcmp(argv[i - 1], "--gap") == 0) opts->gap = atof(value);
+        else if (strcmp(argv[i - 1], "--cpu") == 0) {
+            if (parse_dist(value, &opts->cpu) == FAILURE) return FAILURE;
+        } else if (strcmp(argv[i - 1], "--io") == 0) {
+            if (parse_dist(value, &opts->io) == FAILURE) return FAILURE;
+        } else if (strcmp(argv[i - 1], "--switch") == 0) {
+            if (sscanf(value, "%d:%d", &opts->units_same_switch, &opts->units_diff_switch) != 2) return FAILURE;
+        } else if (strcmp(argv[i - 1], "-o") == 0) opts->output_path = value;
+        else return FAILURE; // unknown flag
+    }
+    if (opts->processes <= 0 || opts->threads <= 0 || opts->min_bursts < 1 || opts->max_bursts < opts->min_bursts
+            || opts->gap < 0 || opts->units_same_switch < 0 || opts->units_diff_switch < 0) return FAILURE;
+    if ((uint64_t)opts->processes * opts->threads > INT32_MAX) return FAILURE;
+    if (opts->binary && opts->output_path == NULL) return FAILURE; // binary output is written through a mapping
+    return SUCCESS;
+}
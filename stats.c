@@ -0,0 +1,98 @@
+/**
+ * stats.c
+ * Statistics report implementation - see stats.h
+ */
+
+#include <stdio.h>
+#include <time.h>
+#include "stats.h"
+
+// wall clock time in seconds, for timing the phases of a run
+double stats_clock(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// prints the report as text
+void print_stats(const RunStats *s, FILE *out) {
+    const LoadStats *load = &s->load;
+    const SimResult *res = s->res;
+    const SimCounters *c = &res->counters;
+    if (load->binary) {
+        fprintf(out, "Input: %zu bytes (binary, memory mapped), %d threads loaded in %.3f s\n", load->bytes,
+                res->threads_read, s->parse_seconds);
+    } else if (s->streamed) {
+        fprintf(out, "Input: %zu bytes, %ld lines (%s) read alongside the simulation\n", load->bytes, load->lines,
+                load->mapped ? "memory mapped" : "read in blocks");
+    } else {
+        fprintf(out, "Input: %zu bytes, %ld lines (%s) parsed in %.3f s (%.1f MB/s)\n", load->bytes, load->lines,
+                load->mapped ? "memory mapped" : "read in blocks", s->parse_seconds,
+                s->parse_seconds > 0 ? load->bytes / s->parse_seconds / 1e6 : 0.0);
+    }
+    fprintf(out, "Resident threads: at most %d of %d held at once\n", s->resident_max, res->threads_read);
+    fprintf(out, "Dispatches: %ld (%s)\n", res->dispatches, policy_name(s->policy));
+    fprintf(out, "Phases: parse %.3f s, simulate %.3f s, report %.3f s\n", s->parse_seconds, s->simulate_seconds,
+            s->report_seconds);
+    fprintf(out, "Queues: %ld inserts, %ld pops, at most %d entries in one queue, %ld allocations (%s events queue)\n",
+            c->queue_inserts, c->queue_pops, c->max_queue_depth, c->allocations, event_queue_name());
+    fprintf(out, "Context switches: %ld in the same process (%ld units), %ld to another process (%ld units)\n",
+            c->same_switches, c->same_switch_time, c->diff_switches, c->diff_switch_time);
+    fprintf(out, "Slices: %ld preempted, %ld ran to the end of the burst\n", c->preemptions, c->bursts_completed);
+    fprintf(out, "Idle time: %ld units waiting for I/O\n", c->idle_time);
+}
+
+// writes the threads' count, mean, extremes and percentiles of one time as a JSON member
+static void write_histogram_json(const char *name, const Histogram *h, const char *separator, FILE *out) {
+    fprintf(out, "    \"%s\": {\"threads\": %ld, \"mean\": %.2f, \"min\": %d, \"p50\": %d, \"p90\": %d, \"p99\": %d,"
+            " \"p99.9\": %d, \"max\": %d}%s\n", name, h->count, h->count > 0 ? (double)h->total / h->count : 0.0, h->min,
+            hist_percentile(h, 50), hist_percentile(h, 90), hist_percentile(h, 99), hist_percentile(h, 99.9), h->max, separator);
+}
+
+// writes the report as a JSON object
+void write_stats_json(const RunStats *s, FILE *out) {
+    const LoadStats *load = &s->load;
+    const SimResult *res = s->res;
+    const SimCounters *c = &res->counters;
+    int i;
+    fprintf(out, "{\n");
+    fprintf(out, "  \"policy\": \"%s\",\n", policy_name(s->policy));
+    fprintf(out, "  \"input\": {\"bytes\": %zu, \"lines\": %ld, \"binary\": %s, \"mapped\": %s, \"streamed\": %s},\n",
+            load->bytes, load->lines, load->binary ? "true" : "false", load->mapped ? "true" : "false",
+            s->streamed ? "true" : "false");
+    fprintf(out, "  \"phases\": {\"parse_seconds\": %.6f, \"simulate_seconds\": %.6f, \"report_seconds\": %.6f},\n",
+            s->parse_seconds, s->simulate_seconds, s->report_seconds);
+    fprintf(out, "  \"threads\": {\"read\": %d, \"resident_max\": %d},\n", res->threads_read, s->resident_max);
+    fprintf(out, "  \"time_total\": %d,\n", res->time_total);
+    fprintf(out, "  \"cpu_time_total\": %d,\n", res->cpu_time_total);
+    fprintf(out, "  \"dispatches\": %ld,\n", res->dispatches);
+    fprintf(out, "  \"event_queue\": \"%s\",\n", event_queue_name());
+    fprintf(out, "  \"counters\": {\n");
+    fprintf(out, "    \"queue_inserts\": %ld,\n", c->queue_inserts);
+    fprintf(out, "    \"queue_pops\": %ld,\n", c->queue_pops);
+    fprintf(out, "    \"max_queue_depth\": %d,\n", c->max_queue_depth);
+    fprintf(out, "    \"allocations\": %ld,\n", c->allocations);
+    fprintf(out, "    \"same_process_switches\": %ld,\n", c->same_switches);
+    fprintf(out, "    \"same_process_switch_time\": %ld,\n", c->same_switch_time);
+    fprintf(out, "    \"different_process_switches\": %ld,\n", c->diff_switches);
+    fprintf(out, "    \"different_process_switch_time\": %ld,\n", c->diff_switch_time);
+    fprintf(out, "    \"preemptions\": %ld,\n", c->preemptions);
+    fprintf(out, "    \"bursts_completed\": %ld,\n", c->bursts_completed);
+    fprintf(out, "    \"idle_time\": %ld\n", c->idle_time);
+    fprintf(out, "  },\n");
+    fprintf(out, "  \"latency\": {\n");
+    write_histogram_json("turnaround", &s->report->turnaround, ",", out);
+    write_histogram_json("waiting", &s->report->waiting, ",", out);
+    write_histogram_json("response", &s->report->response, "", out);
+    fprintf(out, "  }");
+    if (res->core_stats != NULL) {
+        fprintf(out, ",\n  \"cores\": [\n");
+        for (i = 0; i < res->num_cores; i++) {
+            const CoreStats *core = &res->core_stats[i];
+            fprintf(out, "    {\"busy\": %ld, \"dispatches\": %ld, \"migrations\": %ld, \"steals\": %ld}%s\n", core->busy,
+                    core->dispatches, core->migrations, core->steals, i < res->num_cores - 1 ? "," : "");
+        }
+        fprintf(out, "  ]");
+    }
+    fprintf(out, "\n}\n");
+}
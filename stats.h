@@ -0,0 +1,35 @@
+/**
+ * stats.h
+ * The statistics report of a run (the "-s" and "--stats-json" flags): how the input was read,
+ * how long the parse, simulate and report phases took, and what the simulation loop did
+ * according to its counters (see SimCounters in engine.h). It is printed as text after the
+ * usual output, or written as one JSON object (which also holds the latency percentiles of the
+ * report).
+ */
+
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include "engine.h"
+#include "loader.h"
+#include "report.h"
+
+typedef struct run_stats_struct {
+    PolicyKind policy;
+    LoadStats load;
+    bool streamed;           // input was read alongside the simulation, so it has no parse phase
+    int resident_max;        // most threads held at once
+    const SimResult *res;
+    const Report *report;
+    double parse_seconds;
+    double simulate_seconds;
+    double report_seconds;   // printing the results (and details)
+} RunStats;
+
+double stats_clock(void);
+void print_stats(const RunStats *s, FILE *out);
+void write_stats_json(const RunStats *s, FILE *out);
+
+#endif
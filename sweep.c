@@ -0,0 +1,229 @@
+/**
+ * sweep.c
+ * Parameter sweep over policies, quanta and context switch costs, run on a pool of threads.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "sweep.h"
+#include "report.h"
+
+typedef struct sweep_run_struct {
+    PolicyKind policy;
+    int quantum; // 0 if the policy has none
+    SwitchCost cost;
+    SimResult res;
+    long turnaround_total;
+    int turnaround_p50;
+    int turnaround_p99;
+    int waiting_p99;
+    int response_p99;
+} SweepRun;
+
+typedef struct sweep_pool_struct {
+    const Workload *w;
+    const SweepSpec *spec;
+    SweepRun *runs;
+    int num_runs;
+    int next; // next run to hand out
+    pthread_mutex_t lock;
+} SweepPool;
+
+/*--------------------------------- LIST PARSING ---------------------------------*/
+
+// number of comma separated items in text
+static int count_items(const char *text) {
+    int n = 1;
+    for (; *text != '\0'; text++) {
+        if (*text == ',') n++;
+    }
+    return n;
+}
+
+// parses a non-negative int at *p, leaving *p after it; returns -1 if there is none
+static int parse_count(const char **p) {
+    long value = 0;
+    if (**p < '0' || **p > '9') return -1;
+    while (**p >= '0' && **p <= '9') {
+        value = value * 10 + (*(*p)++ - '0');
+        if (value > 1000000000) return -1;
+    }
+    return (int)value;
+}
+
+// parses a comma separated list of positive ints (e.g. "1,5,10"), returns its length or -1 if invalid
+int parse_int_list(const char *text, int **values) {
+    int n = count_items(text);
+    int i;
+    *values = malloc(n * sizeof(int));
+    if (*values == NULL) {
+        fprintf(stderr, "malloc() failed for a sweep list.\n");
+        exit(-1);
+    }
+    for (i = 0; i < n; i++) {
+        (*values)[i] = parse_count(&text);
+        if ((*values)[i] <= 0 || (*text != ',' && *text != '\0')) return -1;
+        text++;
+    }
+    return n;
+}
+
+// parses a comma separated list of policy names (e.g. "fcfs,rr"), returns its length or -1 if invalid
+int parse_policy_list(const char *text, PolicyKind **policies) {
+    int n = count_items(text);
+    int i;
+    char name[32];
+    *policies = malloc(n * sizeof(PolicyKind));
+    if (*policies == NULL) {
+        fprintf(stderr, "malloc() failed for a sweep list.\n");
+        exit(-1);
+    }
+    for (i = 0; i < n; i++) {
+        size_t len = strcspn(text, ",");
+        if (len >= sizeof(name)) return -1;
+        memcpy(name, text, len);
+        name[len] = '\0';
+        if (parse_policy(name, &(*policies)[i]) == 0) return -1;
+        text += len + 1;
+    }
+    return n;
+}
+
+// parses a comma separated list of same:diff switch cost pairs (e.g. "0:0,3:7"), returns its length or -1 if invalid
+int parse_switch_costs(const char *text, SwitchCost **costs) {
+    int n = count_items(text);
+    int i;
+    *costs = malloc(n * sizeof(SwitchCost));
+    if (*costs == NULL) {
+        fprintf(stderr, "malloc() failed for a sweep list.\n");
+        exit(-1);
+    }
+    for (i = 0; i < n; i++) {
+        (*costs)[i].same = parse_count(&text);
+        if ((*costs)[i].same < 0 || *text++ != ':') return -1;
+        (*costs)[i].diff = parse_count(&text);
+        if ((*costs)[i].diff < 0 || (*text != ',' && *text != '\0')) return -1;
+        text++;
+    }
+    return n;
+}
+
+/*--------------------------------- RUNNING ---------------------------------*/
+
+// simulates one configuration on a private copy of the thread records, leaving the workload untouched
+static void sweep_one(const Workload *w, const SweepSpec *spec, SweepRun *run) {
+    Workload copy = *w; // shares the bursts; the simulation only reads them and allocates nothing
+    int i;
+    copy.units_same_switch = run->cost.same;
+    copy.units_diff_switch = run->cost.diff;
+    copy.streaming = false;
+    copy.threads.arr = malloc(w->threads.count * sizeof(Thread));
+    if (copy.threads.arr == NULL) {
+        fprintf(stderr, "malloc() failed for the threads of a sweep run.\n");
+        exit(-1);
+    }
+    memcpy(copy.threads.arr, w->threads.arr, w->threads.count * sizeof(Thread));
+    if (spec->resume == NULL) {
+        for (i = 0; i < copy.threads.count; i++) reset_thread(&copy.threads.arr[i]);
+    }
+
+    SimConfig cfg;
+    memset(&cfg, 0, sizeof(SimConfig));
+    cfg.policy = run->policy;
+    cfg.quantum = run->quantum;
+    cfg.cores = spec->cores;
+    cfg.migration_cost = spec->migration_cost;
+    cfg.resume = spec->resume;
+    Report report;
+    report_init(&report, false);
+    if (run_simulation(&copy, NULL, &cfg, &report, &run->res) != 0) {
+        fprintf(stderr, "ERROR: %s\n", run->res.error);
+        exit(-1);
+    }
+    run->turnaround_total = report_turnaround_total(&report);
+    run->turnaround_p50 = hist_percentile(&report.turnaround, 50);
+    run->turnaround_p99 = hist_percentile(&report.turnaround, 99);
+    run->waiting_p99 = hist_percentile(&report.waiting, 99);
+    run->response_p99 = hist_percentile(&report.response, 99);
+    report_free(&report);
+    free(copy.threads.arr);
+}
+
+// worker: runs configurations until there are none left
+static void *sweep_worker(void *arg) {
+    SweepPool *pool = arg;
+    for (;;) {
+        pthread_mutex_lock(&pool->lock);
+        int i = pool->next < pool->num_runs ? pool->next++ : -1;
+        pthread_mutex_unlock(&pool->lock);
+        if (i == -1) return NULL;
+        sweep_one(pool->w, pool->spec, &pool->runs[i]);
+    }
+}
+
+// Simulates the fully loaded workload under every configuration of the sweep and prints the results
+// as CSV, one row per configuration in the order of the lists (policies, then quanta, then switch costs).
+void run_sweep(const Workload *w, const SweepSpec *spec, FILE *out) {
+    SweepPool pool;
+    int p, q, c, i;
+    int max_runs = spec->num_policies * (spec->num_quanta > 0 ? spec->num_quanta : 1) * spec->num_switch_costs;
+    pool.w = w;
+    pool.spec = spec;
+    pool.runs = malloc(max_runs * sizeof(SweepRun));
+    if (pool.runs == NULL) {
+        fprintf(stderr, "malloc() failed for the sweep runs.\n");
+        exit(-1);
+    }
+    pool.num_runs = 0;
+    pool.next = 0;
+    for (p = 0; p < spec->num_policies; p++) {
+        // a policy without a quantum is run once per switch cost, not once per quantum
+        int num_quanta = policy_uses_quantum(spec->policies[p]) && spec->num_quanta > 0 ? spec->num_quanta : 1;
+        for (q = 0; q < num_quanta; q++) {
+            for (c = 0; c < spec->num_switch_costs; c++) {
+                SweepRun *run = &pool.runs[pool.num_runs++];
+                run->policy = spec->policies[p];
+                run->quantum = 0;
+                if (policy_uses_quantum(run->policy)) run->quantum = spec->num_quanta > 0 ? spec->quanta[q] : MLFQ_DEFAULT_QUANTUM;
+                run->cost = spec->switch_costs[c];
+            }
+        }
+    }
+
+    int jobs = spec->jobs > 0 ? spec->jobs : (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (jobs < 1) jobs = 1;
+    if (jobs > pool.num_runs) jobs = pool.num_runs;
+    pthread_t *workers = malloc(jobs * sizeof(pthread_t));
+    if (workers == NULL) {
+        fprintf(stderr, "malloc() failed for the sweep workers.\n");
+        exit(-1);
+    }
+    pthread_mutex_init(&pool.lock, NULL);
+    for (i = 0; i < jobs; i++) {
+        if (pthread_create(&workers[i], NULL, sweep_worker, &pool) != 0) {
+            fprintf(stderr, "ERROR: could not start sweep worker thread\n");
+            exit(-1);
+        }
+    }
+    for (i = 0; i < jobs; i++) pthread_join(workers[i], NULL);
+    pthread_mutex_destroy(&pool.lock);
+
+    fprintf(out, "policy,quantum,same_switch,diff_switch,cores,total_time,average_turnaround,cpu_utilization,"
+            "p50_turnaround,p99_turnaround,p99_waiting,p99_response\n");
+    for (i = 0; i < pool.num_runs; i++) {
+        SweepRun *run = &pool.runs[i];
+        int time_total = run->res.time_total;
+        fprintf(out, "%s,", policy_name(run->policy));
+        if (run->quantum > 0) fprintf(out, "%d", run->quantum);
+        fprintf(out, ",%d,%d,%d,%d,%.2f,%.2f", run->cost.same, run->cost.diff, spec->cores, time_total,
+                (double)run->turnaround_total / (double)w->num_processes,
+                time_total > 0 ? 100 * (double)run->res.cpu_time_total / ((double)time_total * spec->cores) : 0.0);
+        fprintf(out, ",%d,%d,%d,%d\n", run->turnaround_p50, run->turnaround_p99, run->waiting_p99, run->response_p99);
+        free_sim_result(&run->res);
+    }
+    free(workers);
+    free(pool.runs);
+}
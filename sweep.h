@@ -0,0 +1,42 @@
+/**
+ * sweep.h
+ * Parameter sweep: simulates one workload under every combination of the given policies, quanta
+ * and context switch costs, and prints one CSV row per combination. The workload is loaded once
+ * and only read by the runs; each run works on its own copy of the thread records (its arrival
+ * times, current bursts and remaining times), which point at the shared burst arrays. Runs are
+ * spread over a pool of threads, one per host CPU unless told otherwise.
+ * With a resume state, every run carries on from it and the threads' state in the workload (see
+ * checkpoint.h) rather than starting from the beginning.
+ */
+
+#ifndef SWEEP_H
+#define SWEEP_H
+
+#include <stdio.h>
+#include "engine.h"
+#include "loader.h"
+
+typedef struct switch_cost_struct {
+    int same; // switch to new thread in same process
+    int diff; // switch to new thread in different process
+} SwitchCost;
+
+typedef struct sweep_spec_struct {
+    PolicyKind *policies;
+    int num_policies;
+    int *quanta; // only used by policies that have a quantum
+    int num_quanta;
+    SwitchCost *switch_costs;
+    int num_switch_costs;
+    int cores;
+    int migration_cost;
+    int jobs; // worker threads, 0 for one per host CPU
+    const SimState *resume; // if not NULL, where every run starts
+} SweepSpec;
+
+int parse_int_list(const char *text, int **values);
+int parse_policy_list(const char *text, PolicyKind **policies);
+int parse_switch_costs(const char *text, SwitchCost **costs);
+void run_sweep(const Workload *w, const SweepSpec *spec, FILE *out);
+
+#endif
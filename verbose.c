@@ -0,0 +1,98 @@
+/**
+ * verbose.c
+ * Verbose mode reorder buffer - see verbose.h
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "simcpu.h"
+#include "verbose.h"
+
+#define VERBOSE_INITIAL_CAPACITY 256
+
+// returns non-zero if line a is printed before line b
+static inline int line_less(const VerboseLine *a, const VerboseLine *b) {
+    if (a->time != b->time) return a->time < b->time;
+    if ((a->state1 == NEW_NUM) != (b->state1 == NEW_NUM)) return a->state1 == NEW_NUM; // arrivals first
+    return a->seq < b->seq;
+}
+
+void verbose_init(VerboseBuffer *vb) {
+    vb->arr = NULL;
+    vb->count = 0;
+    vb->capacity = 0;
+    vb->next_seq = 0;
+}
+
+// records a transition of the given thread from state1 to state2 at the given time
+void verbose_add(VerboseBuffer *vb, int time, int process_num, int thread_num, int state1, int state2) {
+    if (vb->count == vb->capacity) {
+        int capacity = vb->capacity > 0 ? vb->capacity * 2 : VERBOSE_INITIAL_CAPACITY;
+        VerboseLine *grown = realloc(vb->arr, capacity * sizeof(VerboseLine));
+        if (grown == NULL) {
+            fprintf(stderr, "realloc() failed for growing the verbose buffer.\n");
+            exit(-1);
+        }
+        vb->arr = grown;
+        vb->capacity = capacity;
+    }
+    VerboseLine line;
+    line.time = time;
+    line.process_num = process_num;
+    line.thread_num = thread_num;
+    line.state1 = state1;
+    line.state2 = state2;
+    line.seq = vb->next_seq++;
+
+    // sift up
+    int index = vb->count++;
+    while (index > 0) {
+        int parent = (index - 1) / 2;
+        if (!line_less(&line, &vb->arr[parent])) break;
+        vb->arr[index] = vb->arr[parent];
+        index = parent;
+    }
+    vb->arr[index] = line;
+}
+
+static VerboseLine pop_line(VerboseBuffer *vb) {
+    VerboseLine top = vb->arr[0];
+    VerboseLine moving = vb->arr[--vb->count];
+    int index = 0;
+    for (;;) {
+        int child = index * 2 + 1;
+        if (child >= vb->count) break;
+        if (child + 1 < vb->count && line_less(&vb->arr[child + 1], &vb->arr[child])) child++;
+        if (!line_less(&vb->arr[child], &moving)) break;
+        vb->arr[index] = vb->arr[child];
+        index = child;
+    }
+    if (vb->count > 0) vb->arr[index] = moving;
+    return top;
+}
+
+static inline void print_line(const VerboseLine *line, OutputWriter *out) {
+    output_transition(out, line->time, line->process_num, line->thread_num, line->state1, line->state2);
+}
+
+// prints every buffered line with a time strictly before the watermark, the earliest possible
+// time of any transition that has not been recorded yet
+void verbose_flush(VerboseBuffer *vb, int watermark, OutputWriter *out) {
+    while (vb->count > 0 && vb->arr[0].time < watermark) {
+        VerboseLine line = pop_line(vb);
+        print_line(&line, out);
+    }
+}
+
+// prints everything left in the buffer (at the end of the simulation)
+void verbose_flush_all(VerboseBuffer *vb, OutputWriter *out) {
+    while (vb->count > 0) {
+        VerboseLine line = pop_line(vb);
+        print_line(&line, out);
+    }
+}
+
+void verbose_free(VerboseBuffer *vb) {
+    free(vb->arr);
+    verbose_init(vb);
+}
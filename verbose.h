@@ -0,0 +1,38 @@
+/**
+ * verbose.h
+ * Reorder buffer for verbose mode. The simulation records state transitions as soon as it
+ * knows about them, which is not always in time order (e.g. a thread's move from BLOCKED to
+ * READY is known when it leaves the CPU). Lines are held in a min-heap keyed on
+ * (time, NEW before anything else, order recorded) and printed once no future transition can
+ * come before them, so memory is bounded by the transitions still in flight, not the whole run.
+ * Lines are printed through an OutputWriter (see output.h), in any of its formats.
+ */
+
+#ifndef VERBOSE_H
+#define VERBOSE_H
+
+#include "output.h"
+
+typedef struct verbose_struct {
+    int time;
+    int thread_num;
+    int process_num;
+    int state1;
+    int state2;
+    long seq; // order the line was recorded in, breaks ties in time
+} VerboseLine;
+
+typedef struct verbose_buffer_struct {
+    VerboseLine *arr;
+    int count;
+    int capacity;
+    long next_seq;
+} VerboseBuffer;
+
+void verbose_init(VerboseBuffer *vb);
+void verbose_add(VerboseBuffer *vb, int time, int process_num, int thread_num, int state1, int state2);
+void verbose_flush(VerboseBuffer *vb, int watermark, OutputWriter *out);
+void verbose_flush_all(VerboseBuffer *vb, OutputWriter *out);
+void verbose_free(VerboseBuffer *vb);
+
+#endif